@@ -21,17 +21,26 @@ namespace jumpinjack
   int GlobalDefs::max_jump_speed = 25;
   int GlobalDefs::base_friction = 2;
   int GlobalDefs::framerate = 25;
+  bool GlobalDefs::late_present = false;
+  bool GlobalDefs::headless = false;
+  int GlobalDefs::turbo = TURBO_OFF;
+  unsigned int GlobalDefs::random_seed = 0;
 
   int GlobalDefs::jump_sensitivity = 5;
 
-  string GlobalDefs::getResource (t_resource type, const char * file)
+  string GlobalDefs::getResourceRoot (void)
   {
-    stringstream ss;
 #ifdef RESOURCES_DIR
-    ss << RESOURCES_DIR;
+    return RESOURCES_DIR;
 #else
-    ss << "data";
+    return "data";
 #endif
+  }
+
+  string GlobalDefs::getResource (t_resource type, const char * file)
+  {
+    stringstream ss;
+    ss << getResourceRoot ();
     switch (type)
       {
       case RESOURCE_IMAGE:
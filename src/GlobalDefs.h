@@ -14,6 +14,9 @@
 #include <algorithm>
 
 #define FRAMERATE_DYNAMIC  -1
+/* GlobalDefs::turbo */
+#define TURBO_OFF           0
+#define TURBO_NO_RENDER    -1
 #define MAX_EVENTS         20
 #define MAX_LEVEL_ITEMS   400
 #define MAX_PLAYERS         4
@@ -49,6 +52,8 @@ typedef enum
   EVENT_DOWN,
   EVENT_SHOOT,
   EVENT_SPRINT,
+  EVENT_TOGGLE_HUD,
+  EVENT_TOGGLE_MEMORY,
   EVENT_EXIT
 } t_event;
 
@@ -147,9 +152,20 @@ namespace jumpinjack
       static int max_falling_speed;
       static int base_friction;
       static int framerate;
+      /* sleep before the frame instead of after it, less input lag */
+      static bool late_present;
+      /* hidden window, software renderer, no audio device (replays) */
+      static bool headless;
+      /* ticks as fast as possible, no vsync or pacing. Every turbo-th tick
+       * is rendered, none with TURBO_NO_RENDER. Timers still count
+       * framerate ticks per second of play */
+      static int turbo;
+      /* srand () at level start, stored in recordings */
+      static unsigned int random_seed;
 
       static int jump_sensitivity;
 
+      static std::string getResourceRoot (void);
       static std::string getResource (t_resource type, const char * file);
   };
 
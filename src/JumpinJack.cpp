@@ -8,16 +8,165 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "GlobalDefs.h"
 #include "sdl/SdlManager.h"
+#include "sdl/AssetPack.h"
+#include "utils/Tracer.h"
+#include "utils/AllocTracker.h"
 
 using namespace jumpinjack;
 using namespace std;
 
-int main (void)
+static void usage (void)
 {
+  fprintf (stderr, "usage: jumpinjack [--hud] [--timings-csv file] "
+           "[--trace file] [--hitch-budget ms]\n"
+           "                  [--alloc-log file] [--alloc-strict] "
+           "[--mem-report] [--late-present]\n"
+           "                  [--record file [--hash] | --replay file "
+           "[--replay-from tick\n"
+           "                  | --batch m] | --verify file] [--turbo k]\n"
+           "  --hud          show the frame timing graph (F3 toggles it)\n"
+           "  --timings-csv  write per phase frame timings to file\n"
+           "  --trace        write a chrome://tracing file on exit "
+           "(make TRACE=1)\n"
+           "  --hitch-budget frames whose work exceeds it dump the flight "
+           "recorder\n                 (default one frame, 0 disables)\n"
+           "  --alloc-log    write per frame allocation counts to file "
+           "(make ALLOC=1)\n"
+           "  --alloc-strict abort on any allocation in a warmed up level "
+           "(make ALLOC=1)\n"
+           "  --mem-report   print memory by subsystem and asset on level "
+           "load and exit\n                 (F4 shows it live)\n"
+           "  --late-present sleep before the frame instead of after it, "
+           "less input lag\n"
+           "  --record       write the session's input to file\n"
+           "  --hash         also write the level's state hash every tick\n"
+           "  --replay       play a recorded session headless, as fast as "
+           "possible\n"
+           "  --replay-from  seek to tick through the recording's keyframes "
+           "before playing\n"
+           "  --batch        replay in m simulations at once and report "
+           "their ticks per\n                 second\n"
+           "  --verify       replay a recording made with --hash and report "
+           "where it\n                 diverges\n"
+           "  --turbo        no vsync or pacing, render every k-th tick (0: "
+           "never) and\n                 report ticks per second. Replays "
+           "are shown when k > 0\n");
+}
+
+static void finish (const char * trace_file)
+{
+  if (trace_file && !TRACE_EXPORT (trace_file))
+    fprintf (stderr, "Unable to write trace %s\n", trace_file);
+  ALLOC_REPORT ();
+}
+
+int main (int argc, char ** argv)
+{
+  bool show_hud = false;
+  const char * timings_csv = 0;
+  const char * trace_file = 0;
+  double hitch_budget = -1;
+  const char * alloc_log = 0;
+  bool alloc_strict = false;
+  bool mem_report = false;
+  bool late_present = false;
+  const char * record_file = 0;
+  const char * replay_file = 0;
+  Uint32 replay_from = 0;
+  int batch = 0;
+  bool record_hashes = false;
+  const char * verify_file = 0;
+  int turbo = TURBO_OFF;
+  for (int arg = 1; arg < argc; ++arg)
+    {
+      if (!strcmp (argv[arg], "--hud"))
+        show_hud = true;
+      else if (!strcmp (argv[arg], "--timings-csv") && arg + 1 < argc)
+        timings_csv = argv[++arg];
+      else if (!strcmp (argv[arg], "--trace") && arg + 1 < argc)
+        trace_file = argv[++arg];
+      else if (!strcmp (argv[arg], "--hitch-budget") && arg + 1 < argc)
+        hitch_budget = atof (argv[++arg]);
+      else if (!strcmp (argv[arg], "--alloc-log") && arg + 1 < argc)
+        alloc_log = argv[++arg];
+      else if (!strcmp (argv[arg], "--alloc-strict"))
+        alloc_strict = true;
+      else if (!strcmp (argv[arg], "--mem-report"))
+        mem_report = true;
+      else if (!strcmp (argv[arg], "--late-present"))
+        late_present = true;
+      else if (!strcmp (argv[arg], "--record") && arg + 1 < argc)
+        record_file = argv[++arg];
+      else if (!strcmp (argv[arg], "--replay") && arg + 1 < argc)
+        replay_file = argv[++arg];
+      else if (!strcmp (argv[arg], "--hash"))
+        record_hashes = true;
+      else if (!strcmp (argv[arg], "--verify") && arg + 1 < argc)
+        verify_file = argv[++arg];
+      else if (!strcmp (argv[arg], "--turbo") && arg + 1 < argc)
+        {
+          turbo = atoi (argv[++arg]);
+          if (turbo <= 0)
+            turbo = TURBO_NO_RENDER;
+        }
+      else if (!strcmp (argv[arg], "--replay-from") && arg + 1 < argc)
+        replay_from = strtoul (argv[++arg], 0, 10);
+      else if (!strcmp (argv[arg], "--batch") && arg + 1 < argc)
+        batch = atoi (argv[++arg]);
+      else
+        {
+          usage ();
+          return EXIT_FAILURE;
+        }
+    }
+
+#ifndef JJ_TRACE
+  if (trace_file)
+    fprintf (stderr, "--trace needs a build with TRACE=1\n");
+#endif
+#ifdef JJ_ALLOC_TRACK
+  if (alloc_log && !ALLOC_LOG (alloc_log))
+    fprintf (stderr, "Unable to write %s\n", alloc_log);
+  ALLOC_STRICT (alloc_strict);
+#else
+  if (alloc_log || alloc_strict)
+    fprintf (stderr, "--alloc-log and --alloc-strict need a build with "
+             "ALLOC=1\n");
+#endif
+
+  if ((record_file != 0) + (replay_file != 0) + (verify_file != 0) > 1
+      || (replay_from && !replay_file) || (record_hashes && !record_file)
+      || batch < 0 || (batch && (!replay_file || replay_from)))
+    {
+      usage ();
+      return EXIT_FAILURE;
+    }
+  /* replays run without a window unless turbo mode shows them */
+  GlobalDefs::turbo = turbo;
+  GlobalDefs::late_present = late_present;
+  GlobalDefs::headless = (replay_file || verify_file)
+      && (turbo <= 0 || batch);
+
+  TRACE_THREAD_NAME ("main");
   SdlManager manager;
+  FrameProfiler * profiler = manager.getProfiler ();
+  profiler->setHudVisible (show_hud);
+  if (timings_csv && !profiler->openCsv (timings_csv))
+    fprintf (stderr, "Unable to write %s\n", timings_csv);
+  if (hitch_budget >= 0)
+    manager.getFlightRecorder ()->setBudget (hitch_budget);
+  manager.setMemoryDump (mem_report);
+  if (record_file)
+    manager.recordTo (record_file, record_hashes);
+
+  manager.mapEvent (ETYPE_KEYBOARD, SDL_SCANCODE_F3, EVENT_TOGGLE_HUD,
+                    TRIGGER_DOWN);
+  manager.mapEvent (ETYPE_KEYBOARD, SDL_SCANCODE_F4, EVENT_TOGGLE_MEMORY,
+                    TRIGGER_DOWN);
   manager.mapEvent (ETYPE_KEYBOARD, SDL_SCANCODE_ESCAPE, EVENT_MENU_LOAD,
                     TRIGGER_DOWN);
 
@@ -46,6 +195,24 @@ int main (void)
   manager.addPlayer (GlobalDefs::getResource (RESOURCE_IMAGE, "player1.png"),
                      4, 0, 3);
 
+  if (replay_file && batch)
+    {
+      bool same = manager.runBatch (replay_file, batch);
+      finish (trace_file);
+      return same ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  if (replay_file)
+    {
+      bool replayed = manager.runReplay (replay_file, replay_from);
+      finish (trace_file);
+      return replayed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  if (verify_file)
+    {
+      bool verified = manager.verifyReplay (verify_file);
+      finish (trace_file);
+      return verified ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
 
   bool in_game = true;
@@ -56,7 +223,9 @@ int main (void)
       TTF_GetError ());
     }
 
-  TTF_Font * font = TTF_OpenFont ("data/fonts/zorque.ttf", 30);
+  TTF_Font * font = TTF_OpenFontRW (
+      AssetPack::openRW (GlobalDefs::getResource (RESOURCE_FONT, "zorque.ttf")),
+      1, 30);
   if (font == NULL)
     {
       printf ("Failed to load lazy font! SDL_ttf Error: %s\n", TTF_GetError ());
@@ -66,7 +235,10 @@ int main (void)
   if (i == 1)
     in_game = false;
 
-  manager.startLevel (1);
+  int level_id = 1;
+  manager.startLevel (level_id);
+  /* streamed in while this one is played */
+  manager.preloadLevel (level_id + 1);
 
   bool game_paused = false;
   while (in_game)
@@ -82,53 +254,72 @@ int main (void)
         }
 
       t_point point;
-      while ((event = manager.pollSingleEvent (&point)) != EVENT_NONE)
-        {
-          switch (event)
-            {
-            case EVENT_EXIT:
-              in_game = false;
-              break;
-            case EVENT_MENU_LOAD:
-              game_paused = true;
-              break;
-            case EVENT_MENU_UNLOAD:
-              game_paused = false;
-              break;
-            case EVENT_LEFT:
-              next_action |= ACTION_LEFT;
-              break;
-            case EVENT_RIGHT:
-              next_action |= ACTION_RIGHT;
-              break;
-            case EVENT_UP:
-              next_action |= ACTION_UP;
-              break;
-            case EVENT_UP_RELEASE:
-              next_action |= ACTION_UP_REL;
-              break;
-            case EVENT_DOWN:
-              next_action |= ACTION_DOWN;
-              break;
-            case EVENT_SHOOT:
-              next_action |= ACTION_SHOOT;
-              break;
-            case EVENT_SPRINT:
-              next_action |= ACTION_SPRINT;
-              break;
-            default:
-              break;
-            }
-        }
+      {
+        ProfilePhase profile (profiler, PHASE_DISPATCH);
+        while ((event = manager.pollSingleEvent (&point)) != EVENT_NONE)
+          {
+            switch (event)
+              {
+              case EVENT_EXIT:
+                in_game = false;
+                break;
+              case EVENT_MENU_LOAD:
+                game_paused = true;
+                break;
+              case EVENT_MENU_UNLOAD:
+                game_paused = false;
+                break;
+              case EVENT_LEFT:
+                next_action |= ACTION_LEFT;
+                break;
+              case EVENT_RIGHT:
+                next_action |= ACTION_RIGHT;
+                break;
+              case EVENT_UP:
+                next_action |= ACTION_UP;
+                break;
+              case EVENT_UP_RELEASE:
+                next_action |= ACTION_UP_REL;
+                break;
+              case EVENT_DOWN:
+                next_action |= ACTION_DOWN;
+                break;
+              case EVENT_SHOOT:
+                next_action |= ACTION_SHOOT;
+                break;
+              case EVENT_SPRINT:
+                next_action |= ACTION_SPRINT;
+                break;
+              case EVENT_TOGGLE_HUD:
+                profiler->setHudVisible (!profiler->isHudVisible ());
+                break;
+              case EVENT_TOGGLE_MEMORY:
+                {
+                  MemoryReport * memory = manager.getMemoryReport ();
+                  memory->setOverlayVisible (!memory->isOverlayVisible ());
+                }
+                break;
+              default:
+                break;
+              }
+          }
+      }
+
       manager.applyAction ((t_action) next_action);
 
       /* update */
       manager.update (game_paused);
+      /* the next level takes over at the end of this one, once ready */
+      if (!game_paused && manager.isLevelFinished ()
+          && manager.switchLevel ())
+        manager.preloadLevel (++level_id + 1);
 
       /* render */
       manager.render ();
 
       manager.endLoop ();
     }
+
+  finish (trace_file);
   return EXIT_SUCCESS;
 }
@@ -32,6 +32,11 @@ namespace jumpinjack
 
     behavior_h_colision = (t_behavior_h_collision)
         (BH_COLLISION_TURN_AT_PASSIVE);// | BH_COLLISION_DIE_AT_PLAYER);
+    collision_mask = collisionMask (ITEM_ENEMY);
+    /* other enemies only matter to the ones that turn or die at them */
+    if (!(behavior_h_colision
+        & (BH_COLLISION_TURN_AT_ACTIVE | BH_COLLISION_DIE_AT_ACTIVE)))
+      collision_mask &= ~COLLISION_LAYER (ITEM_ENEMY);
 
     behavior.push_back(new BehaviorWalker(att_speed));
   }
@@ -20,6 +20,7 @@ namespace jumpinjack
                           sprite_start_line, sprite_frequency, {32, 32})
   {
     base_sprite_frequency = sprite_frequency;
+    collision_mask = collisionMask (ITEM_PLAYER);
     resetState();
   }
 
@@ -189,17 +190,29 @@ namespace jumpinjack
       ActiveDrawable::renderFixed (point);
   }
 
+  void Player::saveState (StateWriter & out) const
+  {
+    ActiveDrawable::saveState (out);
+    out.put (player_state);
+  }
+
+  void Player::loadState (StateReader & in)
+  {
+    ActiveDrawable::loadState (in);
+    in.get (player_state);
+  }
+
   void Player::jump()
   {
     jumpId++;
   }
 
-  Projectile * Player::createProjectile(t_point & delta) const
+  Projectile * Player::createProjectile(t_fixed_point & velocity) const
   {
     return new Gunshot (
         renderer,
         GlobalDefs::getResource (RESOURCE_IMAGE, "bullet.png"),
         getDirection (),
-        delta, 0, 60, 0, 750);
+        velocity, 0, 60, 0, 750);
   }
 } /* namespace sdlfw */
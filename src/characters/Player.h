@@ -48,9 +48,12 @@ namespace jumpinjack
 
       virtual void renderFixed (t_point point);
 
-      Projectile * createProjectile(t_point & delta) const;
+      Projectile * createProjectile(t_fixed_point & velocity) const;
       void jump();
 
+      virtual void saveState (StateWriter & out) const;
+      virtual void loadState (StateReader & in);
+
     private:
       playerState player_state;
       int base_sprite_frequency;
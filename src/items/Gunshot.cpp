@@ -5,32 +5,22 @@
  *      Author: diego
  */
 
-#include <cmath>
 #include "Gunshot.h"
 
 namespace jumpinjack
 {
 
   Gunshot::Gunshot (SDL_Renderer * renderer, std::string sprite_file,
-                          t_direction direction, t_point & delta,
+                          t_direction direction, t_fixed_point & velocity,
                           int shooting_angle, int power, int rotation_speed,
                           int lifespan) :
-          Projectile (renderer, sprite_file, direction, delta,
+          Projectile (renderer, sprite_file, direction, velocity,
                       shooting_angle, power, rotation_speed, lifespan)
   {
-    setDirection (direction);
-    att_gravity_effect = 0.0;
-    float rad = shooting_angle * PI / 180;
-    angle = shooting_angle;
-    delta.x = (int) round (power * cos (rad));
-    if (direction == DIRECTION_LEFT)
-      {
-        delta.x *= -1;
-        angle *= -1;
-      }
-    delta.y = (int) -round (power * sin (rad));
-    start_ticks = SDL_GetTicks ();
-
+    /* straight lines, the velocity is the projectile's */
+    setGravityEffect (0);
+    /* and they fly through checkpoints */
+    collision_mask &= ~COLLISION_LAYER (ITEM_CHECK);
   }
 
   Gunshot::~Gunshot ()
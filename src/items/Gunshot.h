@@ -11,7 +11,7 @@ namespace jumpinjack
     public:
       Gunshot (SDL_Renderer * renderer,
                std::string sprite_file,
-               t_direction direction, t_point & delta,
+               t_direction direction, t_fixed_point & velocity,
                int shooting_angle,
                int power,
                int rotation_speed = 0,
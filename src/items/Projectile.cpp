@@ -5,31 +5,30 @@
  *      Author: diego
  */
 
-#include <cmath>
 #include "Projectile.h"
 
 namespace jumpinjack
 {
 
   Projectile::Projectile (SDL_Renderer * renderer, std::string sprite_file,
-                          t_direction direction, t_point & delta,
+                          t_direction direction, t_fixed_point & velocity,
                           int shooting_angle, int power, int rotation_speed,
                           int lifespan) :
-          ActiveDrawable (renderer, sprite_file, 10, 0, 1, {24,24}), lifespan (lifespan),
+          ActiveDrawable (renderer, sprite_file, 10, 0, 1, {24,24}),
+          lifespan (SimClock::fromMillis (lifespan)),
           power (power), rotation_speed (rotation_speed)
   {
     setDirection (direction);
-    att_gravity_effect = 1.0;
-    float rad = shooting_angle * PI / 180;
+    collision_mask = collisionMask (ITEM_PROJECTILE);
+    setGravityEffect (FIXED_ONE);
     angle = shooting_angle;
-    delta.x = (int) round (power * cos (rad));
+    velocity.x = power * fixedCos (shooting_angle);
     if (direction == DIRECTION_LEFT)
       {
-        delta.x *= -1;
+        velocity.x *= -1;
         angle *= -1;
       }
-    delta.y = (int) -round (power * sin (rad));
-    start_ticks = SDL_GetTicks ();
+    velocity.y = -power * fixedSin (shooting_angle);
   }
 
   Projectile::~Projectile ()
@@ -113,7 +112,7 @@ namespace jumpinjack
         next_point.x -= 2;
         angle -= rotation_speed;
       }
-      if (SDL_GetTicks () - start_ticks > lifespan)
+      if (getAge () > lifespan)
       {
         setStatus (STATUS_DYING);
       }
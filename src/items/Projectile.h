@@ -16,8 +16,10 @@ namespace jumpinjack
   class Projectile : public ActiveDrawable
   {
     public:
+      /* velocity gets the 16.16 pixels per tick the shot starts with */
       Projectile (SDL_Renderer * renderer, std::string sprite_file,
-                  t_direction direction, t_point & delta, int shooting_angle, int power,
+                  t_direction direction, t_fixed_point & velocity,
+                  int shooting_angle, int power,
                   int rotation_speed = 10, int lifespan = 4000);
       virtual ~Projectile ();
 
@@ -31,8 +33,7 @@ namespace jumpinjack
       virtual void update (t_point & next_point);
 
     protected:
-      unsigned int start_ticks; /* starting time */
-      unsigned int lifespan;    /* time (millis) the projectile is alive */
+      t_tick lifespan;          /* ticks the projectile is alive */
       int power;                /* shoot power (speed) */
       int rotation_speed;       /* rotation speed */
   };
@@ -15,10 +15,11 @@ namespace jumpinjack
                                     int sprite_line, int sprite_frequency,
                                     int lifespan, int zindex) :
           PassiveDrawable (renderer, sprite_file, sprite_length, sprite_line,
-                           sprite_frequency, zindex), lifespan (lifespan)
+                           sprite_frequency, zindex),
+          one_loop (lifespan == LIFESPAN_ONE_LOOP),
+          lifespan (one_loop ? 0 : SimClock::fromMillis (lifespan))
   {
     unsetStatus(STATUS_LISTENING);
-    start_time = SDL_GetTicks ();
   }
 
   StaticAnimation::~StaticAnimation ()
@@ -46,14 +47,26 @@ namespace jumpinjack
   void StaticAnimation::update (t_point & next_point)
   {
     renderQuad = updateSprite ();
-    if (lifespan == LIFESPAN_ONE_LOOP)
+    if (one_loop)
       {
         if ((sprite_index==(sprite_length-1)) && (sprite_freq_divisor==(sprite_frequency-1)))
           unsetStatus (STATUS_ALIVE);
       }
-    else if (lifespan > 0 && (SDL_GetTicks () - start_time > lifespan))
+    else if (lifespan > 0 && getAge () > lifespan)
           {
             unsetStatus (STATUS_ALIVE);
           }
   }
+
+  void StaticAnimation::saveState (StateWriter & out) const
+  {
+    DrawableItem::saveState (out);
+    out.put (renderQuad);
+  }
+
+  void StaticAnimation::loadState (StateReader & in)
+  {
+    DrawableItem::loadState (in);
+    in.get (renderQuad);
+  }
 } /* namespace jumpinjack */
@@ -26,11 +26,14 @@ namespace jumpinjack
       virtual void update (t_point & next_point);
       virtual void renderFixed (t_point point);
 
+      virtual void saveState (StateWriter & out) const;
+      virtual void loadState (StateReader & in);
+
     private:
       void convertCoordinates (t_point & p);
 
-      unsigned int start_time;
-      unsigned int lifespan;    /* millis */
+      bool one_loop;
+      t_tick lifespan;
 
       t_rect renderQuad;
   };
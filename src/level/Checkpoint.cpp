@@ -18,6 +18,7 @@ namespace jumpinjack
     state = CKP_INIT;
     setDirection (DIRECTION_LEFT);
     taken = false;
+    collision_mask = collisionMask (ITEM_CHECK);
   }
 
   Checkpoint::~Checkpoint ()
@@ -64,4 +65,18 @@ namespace jumpinjack
     ActiveDrawable::update(next_point);
   }
 
+  void Checkpoint::saveState (StateWriter & out) const
+  {
+    ActiveDrawable::saveState (out);
+    out.put (state);
+    out.put (taken);
+  }
+
+  void Checkpoint::loadState (StateReader & in)
+  {
+    ActiveDrawable::loadState (in);
+    in.get (state);
+    in.get (taken);
+  }
+
 } /* namespace jumpinjack */
@@ -28,6 +28,9 @@ namespace jumpinjack
                                        t_point * otherdelta = 0);
       virtual void update (t_point & next_point);
 
+      virtual void saveState (StateWriter & out) const;
+      virtual void loadState (StateReader & in);
+
     protected:
       enum ckp_state{ CKP_INIT, CKP_HIT, CKP_END};
       ckp_state state;       /* rotation speed */
@@ -0,0 +1,178 @@
+/*
+ * LevelBatch.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "LevelBatch.h"
+#include "../utils/Tracer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  LevelBatch::LevelBatch (SDL_Renderer * renderer,
+                          SoundManager * sound_manager,
+                          ThreadPool * thread_pool, int level_id,
+                          size_t n_instances, const string & player_sprite,
+                          int sprite_length, int sprite_start_line,
+                          int sprite_frequency) :
+      sound_manager (sound_manager), thread_pool (thread_pool),
+      gather_entities (false), ticks (0), step_time (0)
+  {
+    TRACE_ZONE ("LevelBatch::load");
+    assert (n_instances > 0);
+    /* nobody listens, and the mixer is not for worker threads */
+    sound_manager->setMuted (true);
+
+    instances.reserve (n_instances);
+    for (size_t i = 0; i < n_instances; i++)
+    {
+      players.push_back (new Player (renderer, player_sprite, sprite_length,
+                                     sprite_start_line, sprite_frequency));
+      vector<Player *> instance_players (1, players.back ());
+
+      LevelManager * level;
+      if (i == 0)
+      {
+        level = new LevelManager (renderer, level_id, instance_players,
+                                  sound_manager, thread_pool);
+        while (!level->loadStep ())
+          ;
+        level->setScripted (true);
+      }
+      else
+        level = new LevelManager (*instances[0], instance_players);
+      level->start ();
+      /* the batch is what runs in parallel */
+      level->setThreadPool (0);
+
+      arenas.push_back (new FrameArena ());
+      level->setFrameArena (arenas.back ());
+      instances.push_back (level);
+    }
+
+    observations.resize (n_instances);
+    memset (observations.data (), 0,
+            n_instances * sizeof(t_batch_observation));
+    instance_entities.resize (n_instances);
+    entity_offsets.assign (n_instances + 1, 0);
+  }
+
+  LevelBatch::~LevelBatch ()
+  {
+    /* the first one holds what the others share */
+    for (size_t i = instances.size (); i-- > 0;)
+      delete instances[i];
+    for (Player * player : players)
+      delete player;
+    for (FrameArena * arena : arenas)
+      delete arena;
+    sound_manager->setMuted (false);
+  }
+
+  size_t LevelBatch::getInstanceCount (void) const
+  {
+    return instances.size ();
+  }
+
+  LevelManager * LevelBatch::getInstance (size_t instance) const
+  {
+    return instances[instance];
+  }
+
+  void LevelBatch::stepInstance (size_t instance, t_action action,
+                                 Uint8 flags)
+  {
+    LevelManager * level = instances[instance];
+    arenas[instance]->reset ();
+
+    level->applyAction (0, action);
+    if (flags & BATCH_REVIVE)
+      level->requestRevive ();
+    if (!(flags & BATCH_PAUSED))
+      level->update ();
+
+    t_batch_observation & observation = observations[instance];
+    observation.tick = level->getClock ().now ();
+    observation.alive = level->is_alive ();
+    observation.items = level->getFrameStats ().items;
+    level->getPlayerState (0, observation.player);
+    if (gather_entities)
+      level->getEntityStates (instance_entities[instance]);
+  }
+
+  void LevelBatch::step (const t_action * actions, const Uint8 * flags)
+  {
+    TRACE_ZONE ("LevelBatch::step");
+    Uint64 start = SDL_GetPerformanceCounter ();
+
+    size_t n_instances = instances.size ();
+    auto step_range = [this, actions, flags] (size_t begin, size_t end,
+                                              int chunk)
+      {
+        for (size_t i = begin; i < end; i++)
+          stepInstance (i, actions[i], flags ? flags[i] : 0);
+      };
+    size_t n_chunks = 1;
+    if (thread_pool)
+      n_chunks = min (n_instances, (size_t) thread_pool->getThreadCount ()
+          * BATCH_CHUNKS_PER_THREAD);
+    if (n_chunks > 1)
+      thread_pool->parallelFor (n_instances, n_chunks, step_range);
+    else
+      step_range (0, n_instances, 0);
+
+    if (gather_entities)
+    {
+      entities.clear ();
+      for (size_t i = 0; i < n_instances; i++)
+      {
+        entity_offsets[i] = entities.size ();
+        entities.insert (entities.end (), instance_entities[i].begin (),
+                         instance_entities[i].end ());
+      }
+      entity_offsets[n_instances] = entities.size ();
+    }
+
+    step_time += SDL_GetPerformanceCounter () - start;
+    ticks += n_instances;
+  }
+
+  const t_batch_observation * LevelBatch::getObservations (void) const
+  {
+    return observations.data ();
+  }
+
+  void LevelBatch::setEntityObservations (bool enabled)
+  {
+    gather_entities = enabled;
+  }
+
+  const t_entity_state * LevelBatch::getEntities (void) const
+  {
+    return entities.data ();
+  }
+
+  const Uint32 * LevelBatch::getEntityOffsets (void) const
+  {
+    return entity_offsets.data ();
+  }
+
+  unsigned long LevelBatch::getTicks (void) const
+  {
+    return ticks;
+  }
+
+  double LevelBatch::getTicksPerSecond (void) const
+  {
+    return step_time ?
+        ticks * (double) SDL_GetPerformanceFrequency () / step_time : 0.0;
+  }
+
+} /* namespace jumpinjack */
@@ -0,0 +1,89 @@
+/*
+ * LevelBatch.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef LEVEL_LEVELBATCH_H_
+#define LEVEL_LEVELBATCH_H_
+
+#include "LevelManager.h"
+#include "../sdl/SoundManager.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/FrameArena.h"
+
+#include <string>
+#include <vector>
+
+/* step () flags, per instance */
+#define BATCH_REVIVE  1   /* back to the last checkpoint, after the clock */
+#define BATCH_PAUSED  2   /* the action is applied, the level not updated */
+
+#define BATCH_CHUNKS_PER_THREAD 2
+
+namespace jumpinjack
+{
+
+  /* what step () leaves for every instance */
+  typedef struct
+  {
+      Uint32 tick;
+      Sint32 alive;
+      Sint32 items;
+      t_entity_state player;  /* zeroed once the player is gone */
+  } t_batch_observation;
+
+  /* many independent games of one level in a single process, for bots
+   * and scripted sessions. Instance 0 loads the level and the others
+   * share its collision and assets, copying only the level data they
+   * change. step () runs them all on the thread pool, one action each */
+  class LevelBatch
+  {
+    public:
+      LevelBatch (SDL_Renderer * renderer, SoundManager * sound_manager,
+                  ThreadPool * thread_pool, int level_id, size_t instances,
+                  const std::string & player_sprite, int sprite_length,
+                  int sprite_start_line, int sprite_frequency);
+      virtual ~LevelBatch ();
+
+      size_t getInstanceCount (void) const;
+      LevelManager * getInstance (size_t instance) const;
+
+      /* one action and BATCH_* flags (0 for none) per instance */
+      void step (const t_action * actions, const Uint8 * flags = 0);
+
+      /* one per instance, back to back */
+      const t_batch_observation * getObservations (void) const;
+      /* all items of every instance back to back, instance i's from
+       * getEntityOffsets ()[i] to [i + 1]. Gathered only when enabled */
+      void setEntityObservations (bool enabled);
+      const t_entity_state * getEntities (void) const;
+      const Uint32 * getEntityOffsets (void) const;
+
+      /* instance ticks over the time spent in step (), all cores */
+      unsigned long getTicks (void) const;
+      double getTicksPerSecond (void) const;
+
+    private:
+      void stepInstance (size_t instance, t_action action, Uint8 flags);
+
+      SoundManager * sound_manager;
+      ThreadPool * thread_pool;
+      std::vector<LevelManager *> instances;
+      std::vector<Player *> players;
+      std::vector<FrameArena *> arenas;
+
+      std::vector<t_batch_observation> observations;
+      bool gather_entities;
+      std::vector<std::vector<t_entity_state> > instance_entities;
+      std::vector<t_entity_state> entities;
+      std::vector<Uint32> entity_offsets;
+
+      unsigned long ticks;
+      Uint64 step_time;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* LEVEL_LEVELBATCH_H_ */
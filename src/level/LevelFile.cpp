@@ -0,0 +1,428 @@
+/*
+ * LevelFile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "LevelFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  bool parseLevelText (istream & myfile, int player_count,
+                       t_level_data & level_data)
+  {
+    string line;
+
+    level_data.player_start_point.reserve (player_count);
+    level_data.player_start_delta.reserve (player_count);
+
+    for (int i = 0; i < player_count; ++i)
+    {
+      t_point position, delta;
+      getline (myfile, line);
+      sscanf (line.c_str (), "{%d,%d} {%d,%d}", &position.x, &position.y,
+              &delta.x, &delta.y);
+      level_data.player_start_point.push_back (position);
+      level_data.player_start_delta.push_back (delta);
+    }
+
+    for (int i = player_count; i < MAX_PLAYERS; i++)
+    {
+      /* skip line */
+      getline (myfile, line);
+    }
+
+    level_data.parallax_layers.resize (PARALLAX_LAYERS);
+    for (int i = 0; i < PARALLAX_LAYERS; i++)
+    {
+      getline (myfile, line);
+      char bg_file_cstr[300];
+      int parallax_level;
+      int repeat_x;
+      int auto_speed;
+      sscanf (line.c_str (), "%s %d %d %d", bg_file_cstr, &parallax_level,
+              &repeat_x, &auto_speed);
+
+      level_data.parallax_layers[i].filename = bg_file_cstr;
+      level_data.parallax_layers[i].parallax_level = parallax_level;
+      level_data.parallax_layers[i].repeat_x = repeat_x;
+      level_data.parallax_layers[i].parallax_speed = auto_speed;
+    }
+
+    getline (myfile, line);
+    level_data.surface_filename = line;
+
+    getline (myfile, line);
+    int n_items = 0;
+    sscanf (line.c_str (), "%d", &n_items);
+    level_data.items.resize (n_items);
+
+    for (int i = 0; i < n_items; ++i)
+    {
+      getline (myfile, line);
+      char resource_img[300], item_typestr[40];
+      int sprite_len, sprite_start, sprite_freq;
+      t_point item_pos, item_delta;
+      t_itemtype item_type = ITEM_PASSIVE;
+      sscanf (line.c_str (), "%s %d %d %d %s {%d,%d} {%d,%d}", resource_img,
+              &sprite_len, &sprite_start, &sprite_freq, item_typestr,
+              &item_pos.x, &item_pos.y, &item_delta.x, &item_delta.y);
+      if (!strcmp (item_typestr, "ITEM_ENEMY"))
+        item_type = ITEM_ENEMY;
+      else if (!strcmp (item_typestr, "ITEM_CHECK"))
+        item_type = ITEM_CHECK;
+
+      level_data.items[i].sprite_filename = resource_img;
+      level_data.items[i].sprite_len      = sprite_len;
+      level_data.items[i].sprite_start    = sprite_start;
+      level_data.items[i].sprite_speed    = sprite_freq;
+      level_data.items[i].type            = item_type;
+      level_data.items[i].start_point     = item_pos;
+      level_data.items[i].start_delta     = item_delta;
+    }
+    return !myfile.fail ();
+  }
+
+  void resolveLevelPaths (t_level_data & level_data)
+  {
+    for (t_parallax_layer & layer : level_data.parallax_layers)
+      layer.filename = GlobalDefs::getResource (RESOURCE_IMAGE,
+                                                layer.filename.c_str ());
+    level_data.surface_filename = GlobalDefs::getResource (
+        RESOURCE_IMAGE, level_data.surface_filename.c_str ());
+
+    /* levels reuse a handful of sprites */
+    map<string, string> resolved;
+    for (t_item_desc & item : level_data.items)
+    {
+      string & path = resolved[item.sprite_filename];
+      if (path.empty ())
+        path = GlobalDefs::getResource (RESOURCE_IMAGE,
+                                        item.sprite_filename.c_str ());
+      item.sprite_filename = path;
+    }
+  }
+
+  LevelFile::LevelFile () :
+      data (0), size (0), mapped (false)
+  {
+  }
+
+  LevelFile::~LevelFile ()
+  {
+    close ();
+  }
+
+  bool LevelFile::open (const string & path)
+  {
+    close ();
+
+    int fd = ::open (path.c_str (), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    if (fstat (fd, &st) < 0 || st.st_size < (off_t) sizeof(t_level_bin_header))
+    {
+      ::close (fd);
+      return false;
+    }
+
+    void * mapping = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+    if (mapping == MAP_FAILED)
+      return false;
+
+    data = (const Uint8 *) mapping;
+    size = st.st_size;
+    mapped = true;
+
+    if (!validate ())
+    {
+      cerr << "Invalid level file " << path << endl;
+      close ();
+      return false;
+    }
+    return true;
+  }
+
+  bool LevelFile::open (const Uint8 * level_data, size_t level_size)
+  {
+    close ();
+
+    if (level_size < sizeof(t_level_bin_header))
+      return false;
+
+    data = level_data;
+    size = level_size;
+
+    if (!validate ())
+    {
+      cerr << "Invalid packed level file" << endl;
+      close ();
+      return false;
+    }
+    return true;
+  }
+
+  void LevelFile::close (void)
+  {
+    if (data && mapped)
+      munmap ((void *) data, size);
+    data = 0;
+    size = 0;
+    mapped = false;
+  }
+
+  bool LevelFile::isOpen (void) const
+  {
+    return data != 0;
+  }
+
+  static bool section_ok (size_t file_size, Uint32 offset, size_t count,
+                          size_t element_size)
+  {
+    return offset % 4 == 0 && offset <= file_size
+        && count <= (file_size - offset) / element_size;
+  }
+
+  bool LevelFile::validate (void) const
+  {
+    const t_level_bin_header * header = getHeader ();
+    if (header->magic != LEVEL_BIN_MAGIC
+        || header->version != LEVEL_BIN_VERSION)
+      return false;
+
+    if (!section_ok (size, header->strings_offset, header->strings_size, 1)
+        || !header->strings_size
+        || data[header->strings_offset + header->strings_size - 1] != '\0')
+      return false;
+
+    if (!section_ok (size, header->players_offset, header->player_count,
+                     sizeof(t_level_bin_player))
+        || !section_ok (size, header->layers_offset, header->layer_count,
+                        sizeof(t_level_bin_layer))
+        || !section_ok (size, header->items_offset, header->item_count,
+                        sizeof(t_level_bin_item)))
+      return false;
+
+    if (header->flags & LEVEL_BIN_FLAG_COLLISION_GRID)
+    {
+      if (header->grid_width <= 0 || header->grid_height <= 0
+          || !section_ok (size, header->grid_offset, header->grid_height,
+                          header->grid_width))
+        return false;
+    }
+
+    /* string references */
+    if (header->surface_filename >= header->strings_size)
+      return false;
+    for (Uint32 i = 0; i < header->layer_count; i++)
+      if (getLayers ()[i].filename >= header->strings_size)
+        return false;
+    for (Uint32 i = 0; i < header->item_count; i++)
+      if (getItems ()[i].sprite_filename >= header->strings_size)
+        return false;
+
+    /* only what a level places, the rest is spawned while playing */
+    for (Uint32 i = 0; i < header->item_count; i++)
+      if (getItems ()[i].type != ITEM_ENEMY
+          && getItems ()[i].type != ITEM_CHECK)
+        return false;
+
+    return true;
+  }
+
+  const t_level_bin_header * LevelFile::getHeader (void) const
+  {
+    return (const t_level_bin_header *) data;
+  }
+
+  const t_level_bin_player * LevelFile::getPlayers (void) const
+  {
+    return (const t_level_bin_player *) (data + getHeader ()->players_offset);
+  }
+
+  const t_level_bin_layer * LevelFile::getLayers (void) const
+  {
+    return (const t_level_bin_layer *) (data + getHeader ()->layers_offset);
+  }
+
+  const t_level_bin_item * LevelFile::getItems (void) const
+  {
+    return (const t_level_bin_item *) (data + getHeader ()->items_offset);
+  }
+
+  const char * LevelFile::getString (Uint32 offset) const
+  {
+    return (const char *) (data + getHeader ()->strings_offset + offset);
+  }
+
+  const Uint8 * LevelFile::getCollisionGrid (void) const
+  {
+    if (!(getHeader ()->flags & LEVEL_BIN_FLAG_COLLISION_GRID))
+      return 0;
+    return data + getHeader ()->grid_offset;
+  }
+
+  bool LevelFile::getLevelData (int player_count,
+                                t_level_data & level_data) const
+  {
+    const t_level_bin_header * header = getHeader ();
+    if (player_count > (int) header->player_count)
+    {
+      cerr << "Compiled level has " << header->player_count
+          << " player starts, " << player_count << " needed" << endl;
+      return false;
+    }
+
+    level_data.player_start_point.resize (player_count);
+    level_data.player_start_delta.resize (player_count);
+    for (int i = 0; i < player_count; ++i)
+    {
+      const t_level_bin_player & player = getPlayers ()[i];
+      level_data.player_start_point[i] = { player.x, player.y };
+      level_data.player_start_delta[i] = { player.dx, player.dy };
+    }
+
+    level_data.parallax_layers.resize (header->layer_count);
+    for (Uint32 i = 0; i < header->layer_count; ++i)
+    {
+      const t_level_bin_layer & layer = getLayers ()[i];
+      level_data.parallax_layers[i].filename = GlobalDefs::getResource (
+          RESOURCE_IMAGE, getString (layer.filename));
+      level_data.parallax_layers[i].parallax_level = layer.parallax_level;
+      level_data.parallax_layers[i].repeat_x = layer.repeat_x;
+      level_data.parallax_layers[i].parallax_speed = layer.parallax_speed;
+    }
+
+    level_data.surface_filename = GlobalDefs::getResource (
+        RESOURCE_IMAGE, getString (header->surface_filename));
+    level_data.items.clear ();
+
+    return true;
+  }
+
+  static Uint32 add_string (vector<char> & strings, map<string, Uint32> & index,
+                            const string & value)
+  {
+    map<string, Uint32>::iterator it = index.find (value);
+    if (it != index.end ())
+      return it->second;
+
+    Uint32 offset = strings.size ();
+    strings.insert (strings.end (), value.begin (), value.end ());
+    strings.push_back ('\0');
+    index[value] = offset;
+    return offset;
+  }
+
+  static Uint32 align4 (size_t offset)
+  {
+    return (offset + 3) & ~3;
+  }
+
+  bool LevelFile::write (const string & path, const t_level_data & level_data,
+                         const Uint8 * grid, int grid_width, int grid_height)
+  {
+    vector<char> strings;
+    map<string, Uint32> index;
+
+    t_level_bin_header header;
+    memset (&header, 0, sizeof(header));
+    header.magic = LEVEL_BIN_MAGIC;
+    header.version = LEVEL_BIN_VERSION;
+    header.player_count = level_data.player_start_point.size ();
+    header.layer_count = level_data.parallax_layers.size ();
+    header.item_count = level_data.items.size ();
+    header.surface_filename = add_string (strings, index,
+                                          level_data.surface_filename);
+
+    vector<t_level_bin_player> bin_players (header.player_count);
+    for (Uint32 i = 0; i < header.player_count; i++)
+    {
+      bin_players[i].x = level_data.player_start_point[i].x;
+      bin_players[i].y = level_data.player_start_point[i].y;
+      bin_players[i].dx = level_data.player_start_delta[i].x;
+      bin_players[i].dy = level_data.player_start_delta[i].y;
+    }
+
+    vector<t_level_bin_layer> bin_layers (header.layer_count);
+    for (Uint32 i = 0; i < header.layer_count; i++)
+    {
+      const t_parallax_layer & layer = level_data.parallax_layers[i];
+      bin_layers[i].filename = add_string (strings, index, layer.filename);
+      bin_layers[i].parallax_level = layer.parallax_level;
+      bin_layers[i].repeat_x = layer.repeat_x;
+      bin_layers[i].parallax_speed = layer.parallax_speed;
+    }
+
+    vector<t_level_bin_item> bin_items (header.item_count);
+    for (Uint32 i = 0; i < header.item_count; i++)
+    {
+      const t_item_desc & item = level_data.items[i];
+      bin_items[i].sprite_filename = add_string (strings, index,
+                                                 item.sprite_filename);
+      bin_items[i].sprite_len = item.sprite_len;
+      bin_items[i].sprite_start = item.sprite_start;
+      bin_items[i].sprite_speed = item.sprite_speed;
+      bin_items[i].type = item.type;
+      bin_items[i].x = item.start_point.x;
+      bin_items[i].y = item.start_point.y;
+      bin_items[i].dx = item.start_delta.x;
+      bin_items[i].dy = item.start_delta.y;
+    }
+
+    /* layout: header, players, layers, items, strings, grid */
+    header.players_offset = align4 (sizeof(header));
+    header.layers_offset = header.players_offset
+        + bin_players.size () * sizeof(t_level_bin_player);
+    header.items_offset = header.layers_offset
+        + bin_layers.size () * sizeof(t_level_bin_layer);
+    header.strings_offset = header.items_offset
+        + bin_items.size () * sizeof(t_level_bin_item);
+    header.strings_size = strings.size ();
+    if (grid)
+    {
+      header.flags |= LEVEL_BIN_FLAG_COLLISION_GRID;
+      header.grid_offset = align4 (header.strings_offset + strings.size ());
+      header.grid_width = grid_width;
+      header.grid_height = grid_height;
+    }
+
+    ofstream out (path.c_str (), ios::binary | ios::trunc);
+    if (!out.is_open ())
+      return false;
+
+    out.write ((const char *) &header, sizeof(header));
+    out.write ((const char *) bin_players.data (),
+               bin_players.size () * sizeof(t_level_bin_player));
+    out.write ((const char *) bin_layers.data (),
+               bin_layers.size () * sizeof(t_level_bin_layer));
+    out.write ((const char *) bin_items.data (),
+               bin_items.size () * sizeof(t_level_bin_item));
+    out.write (strings.data (), strings.size ());
+    if (grid)
+    {
+      static const char padding[4] = { 0, 0, 0, 0 };
+      out.write (padding, header.grid_offset
+                     - (header.strings_offset + strings.size ()));
+      out.write ((const char *) grid, (size_t) grid_width * grid_height);
+    }
+    return out.good ();
+  }
+
+} /* namespace jumpinjack */
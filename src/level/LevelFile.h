@@ -0,0 +1,146 @@
+/*
+ * LevelFile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef LEVEL_LEVELFILE_H_
+#define LEVEL_LEVELFILE_H_
+
+#include "../GlobalDefs.h"
+
+#include <string>
+#include <vector>
+#include <istream>
+
+/* compiled levels: "JJLV" followed by fixed size sections, all offsets are
+ * relative to the start of the file and 4 byte aligned (little endian) */
+#define LEVEL_BIN_MAGIC   0x564C4A4A
+#define LEVEL_BIN_VERSION 1
+
+#define LEVEL_BIN_FLAG_COLLISION_GRID 1
+
+#define PARALLAX_LAYERS 3
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+    std::string filename;
+    int parallax_level;
+    bool repeat_x;
+    int parallax_speed;
+  } t_parallax_layer;
+
+  typedef struct
+  {
+    std::string sprite_filename;
+    int sprite_len;
+    int sprite_start;
+    int sprite_speed;
+    t_itemtype type;
+    t_point start_point;
+    t_point start_delta;
+  } t_item_desc;
+
+  typedef struct
+  {
+    std::vector<t_point> player_start_point;
+    std::vector<t_point> player_start_delta;
+    std::vector<t_parallax_layer> parallax_layers;
+    std::string surface_filename;
+    std::vector<t_item_desc> items;
+  } t_level_data;
+
+  typedef struct
+  {
+      Uint32 magic;
+      Uint16 version;
+      Uint16 flags;
+      Uint32 player_count;
+      Uint32 layer_count;
+      Uint32 item_count;
+      Uint32 surface_filename;  /* string table offset */
+      Uint32 strings_offset;
+      Uint32 strings_size;
+      Uint32 players_offset;
+      Uint32 layers_offset;
+      Uint32 items_offset;
+      Uint32 grid_offset;       /* one pixelType per byte, row major */
+      Sint32 grid_width;
+      Sint32 grid_height;
+  } t_level_bin_header;
+
+  typedef struct
+  {
+      Sint32 x, y;
+      Sint32 dx, dy;
+  } t_level_bin_player;
+
+  typedef struct
+  {
+      Uint32 filename;
+      Sint32 parallax_level;
+      Sint32 repeat_x;
+      Sint32 parallax_speed;
+  } t_level_bin_layer;
+
+  typedef struct
+  {
+      Uint32 sprite_filename;
+      Sint32 sprite_len;
+      Sint32 sprite_start;
+      Sint32 sprite_speed;
+      Sint32 type;
+      Sint32 x, y;
+      Sint32 dx, dy;
+  } t_level_bin_item;
+
+  /* text source format (levelN.dat), file names are kept as written */
+  bool parseLevelText (std::istream & in, int player_count,
+                       t_level_data & level_data);
+  void resolveLevelPaths (t_level_data & level_data);
+
+  /* compiled format (levelN.jjl), mapped read only and used in place */
+  class LevelFile
+  {
+    public:
+      LevelFile ();
+      virtual ~LevelFile ();
+
+      bool open (const std::string & path);
+      /* level already in memory (asset pack), must outlive the LevelFile */
+      bool open (const Uint8 * level_data, size_t level_size);
+      void close (void);
+      bool isOpen (void) const;
+
+      const t_level_bin_header * getHeader (void) const;
+      const t_level_bin_player * getPlayers (void) const;
+      const t_level_bin_layer * getLayers (void) const;
+      const t_level_bin_item * getItems (void) const;
+      const char * getString (Uint32 offset) const;
+      const Uint8 * getCollisionGrid (void) const;
+
+      /* file names come out resolved, like parseLevelText + resolve.
+       * Items are not copied, they are read with getItems (). False
+       * when the file has fewer player starts than player_count */
+      bool getLevelData (int player_count, t_level_data & level_data) const;
+
+      static bool write (const std::string & path,
+                         const t_level_data & level_data,
+                         const Uint8 * grid = 0, int grid_width = 0,
+                         int grid_height = 0);
+
+    private:
+      bool validate (void) const;
+
+      const Uint8 * data;
+      size_t size;
+      bool mapped;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* LEVEL_LEVELFILE_H_ */
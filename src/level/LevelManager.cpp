@@ -10,8 +10,13 @@
 #include "Checkpoint.h"
 #include <sstream>
 #include <fstream>
+#include <cstring>
+#include <sys/stat.h>
 #include "../items/Gunshot.h"
 #include "../items/StaticAnimation.h"
+#include "../sdl/AssetPack.h"
+#include "../utils/Tracer.h"
+#include "../utils/Counters.h"
 
 using namespace std;
 
@@ -20,95 +25,103 @@ namespace jumpinjack
 
   t_direction reverseDirection (t_direction dir);
 
-  static void parse_level_file(int level_id, int player_count, t_level_data & level_data)
+  static string level_filename (int level_id, const char * extension)
   {
     stringstream ss;
-    string line;
-    string filename;
-    ss << "level" << level_id << ".dat";
-    filename = GlobalDefs::getResource (RESOURCE_DATA, ss.str().c_str());
+    ss << "level" << level_id << extension;
+    return GlobalDefs::getResource (RESOURCE_DATA, ss.str().c_str());
+  }
 
-    ifstream myfile (filename);
-    assert (myfile.is_open ());
+  /* the compiled level is used unless the text source is newer */
+  static bool open_compiled_level (int level_id, LevelFile & level_file)
+  {
+    string bin_filename = level_filename (level_id, ".jjl");
+    string txt_filename = level_filename (level_id, ".dat");
 
-    level_data.player_start_point.reserve (player_count);
-    level_data.player_start_delta.reserve (player_count);
+    /* the pack is built from the data directory as a whole */
+    const Uint8 * packed;
+    size_t packed_size;
+    if (AssetPack::find (bin_filename, &packed, &packed_size))
+      return level_file.open (packed, packed_size);
 
-    for (int i = 0; i < player_count; ++i)
+    struct stat bin_stat, txt_stat;
+    if (stat (bin_filename.c_str (), &bin_stat) < 0)
+      return false;
+    if (stat (txt_filename.c_str (), &txt_stat) == 0
+        && txt_stat.st_mtime > bin_stat.st_mtime)
     {
-      t_point position, delta;
-      getline (myfile, line);
-      sscanf (line.c_str (), "{%d,%d} {%d,%d}", &position.x, &position.y,
-              &delta.x, &delta.y);
-      level_data.player_start_point.push_back (position);
-      level_data.player_start_delta.push_back (delta);
+      cerr << bin_filename << " is older than its source, ignoring it" << endl;
+      return false;
     }
+    return level_file.open (bin_filename);
+  }
 
-    for (int i = player_count; i < MAX_PLAYERS; i++)
+  static bool parse_level_file(int level_id, int player_count, t_level_data & level_data)
+  {
+    TRACE_ZONE ("parseLevel");
+    LevelFile level_file;
+    if (open_compiled_level (level_id, level_file)
+        && level_file.getLevelData (player_count, level_data))
+      return true;
+
+    string txt_filename = level_filename (level_id, ".dat");
+    bool level_ok;
+    const Uint8 * packed;
+    size_t packed_size;
+    if (AssetPack::find (txt_filename, &packed, &packed_size))
     {
-      /* skip line */
-      getline (myfile, line);
+      istringstream packed_file (string ((const char *) packed, packed_size));
+      level_ok = parseLevelText (packed_file, player_count, level_data);
     }
-
-    level_data.parallax_layers.resize (PARALLAX_LAYERS);
-    for (int i = 0; i < PARALLAX_LAYERS; i++)
+    else
     {
-      getline (myfile, line);
-      char bg_file_cstr[300];
-      string bg_file;
-      int parallax_level;
-      int repeat_x;
-      int auto_speed;
-      sscanf (line.c_str (), "%s %d %d %d", bg_file_cstr, &parallax_level,
-              &repeat_x, &auto_speed);
-      bg_file = GlobalDefs::getResource (RESOURCE_IMAGE, bg_file_cstr);
+      ifstream myfile (txt_filename);
+      if (!myfile.is_open ())
+        return false;
 
-      level_data.parallax_layers[i].filename = bg_file;
-      level_data.parallax_layers[i].parallax_level = parallax_level;
-      level_data.parallax_layers[i].repeat_x = repeat_x;
-      level_data.parallax_layers[i].parallax_speed = auto_speed;
+      level_ok = parseLevelText (myfile, player_count, level_data);
+      myfile.close ();
     }
+    resolveLevelPaths (level_data);
+    return level_ok;
+  }
 
-    getline (myfile, line);
-    level_data.surface_filename = GlobalDefs::getResource (RESOURCE_IMAGE, line.c_str ());
+  bool LevelManager::parseLevel (int level_id, int player_count,
+                                 t_level_data & level_data)
+  {
+    return parse_level_file (level_id, player_count, level_data);
+  }
 
-    getline (myfile, line);
-    int n_items;
-    sscanf (line.c_str (), "%d", &n_items);
-    level_data.items.resize (n_items);
+  bool LevelManager::isCompiled (int level_id)
+  {
+    LevelFile level_file;
+    return open_compiled_level (level_id, level_file);
+  }
 
-    for (int i = 0; i < n_items; ++i)
+  bool LevelManager::levelExists (int level_id)
+  {
+    const char * extensions[] = { ".jjl", ".dat" };
+    for (const char * extension : extensions)
     {
-      getline (myfile, line);
-      char resource_img[300], item_typestr[40];
-      int sprite_len, sprite_start, sprite_freq;
-      t_point item_pos, item_delta;
-      t_itemtype item_type = ITEM_PASSIVE;
-      sscanf (line.c_str (), "%s %d %d %d %s {%d,%d} {%d,%d}", resource_img,
-              &sprite_len, &sprite_start, &sprite_freq, item_typestr,
-              &item_pos.x, &item_pos.y, &item_delta.x, &item_delta.y);
-      if (!strcmp (item_typestr, "ITEM_ENEMY"))
-        item_type = ITEM_ENEMY;
-      else if (!strcmp (item_typestr, "ITEM_CHECK"))
-        item_type = ITEM_CHECK;
-
-      level_data.items[i].sprite_filename = GlobalDefs::getResource (RESOURCE_IMAGE, resource_img);
-      level_data.items[i].sprite_len      = sprite_len;
-      level_data.items[i].sprite_start    = sprite_start;
-      level_data.items[i].sprite_speed    = sprite_freq;
-      level_data.items[i].type            = item_type;
-      level_data.items[i].start_point     = item_pos;
-      level_data.items[i].start_delta     = item_delta;
+      string filename = level_filename (level_id, extension);
+      const Uint8 * packed;
+      size_t packed_size;
+      struct stat file_stat;
+      if (AssetPack::find (filename, &packed, &packed_size)
+          || stat (filename.c_str (), &file_stat) == 0)
+        return true;
     }
-    myfile.close ();
+    return false;
   }
 
   void LevelManager::saveLevelData(void)
   {
+    TRACE_ZONE ("LevelManager::saveLevelData");
     /* clean */
     level_data.player_start_point.clear();
     level_data.player_start_delta.clear();
     level_data.items.clear();
+    items_in_file = false;
 
     for (itemInfo & it : items)
     {
@@ -140,6 +153,7 @@ namespace jumpinjack
   }
   void LevelManager::loadLevelData(void)
   {
+    TRACE_ZONE ("LevelManager::loadLevelData");
     paused = false;
     alive = true;
 
@@ -157,15 +171,10 @@ namespace jumpinjack
     }
     bg_layers.clear();
 
-    if (level_surface)
-    {
-      delete level_surface;
-      level_surface = 0;
-    }
-
     /* load */
 
     items.reserve (MAX_LEVEL_ITEMS);
+    boxes.reserve (MAX_LEVEL_ITEMS);
     int i = 0;
     for (itemInfo & playerInfo : players)
     {
@@ -195,46 +204,144 @@ namespace jumpinjack
                                     p_layer.parallax_level, p_layer.repeat_x,
                                     p_layer.parallax_speed));
       }
-    level_surface = new Surface (level_data.surface_filename);
-    for (t_item_desc & item_desc : level_data.items)
+    if (items_in_file)
     {
-      switch (item_desc.type)
+      /* straight from the mapped array */
+      const t_level_bin_item * bin_items = level_file.getItems ();
+      for (Uint32 n = 0; n < level_file.getHeader ()->item_count; n++)
       {
-        case ITEM_ENEMY:
-          items.push_back (
-                { new Enemy (renderer, item_desc.sprite_filename,
-                  item_desc.sprite_len, item_desc.sprite_start,
-                  item_desc.sprite_speed),
-                  ITEM_ENEMY,
-                  item_desc.start_point, item_desc.start_delta,
-                  item_desc.start_point, item_desc.start_delta,
-                  true });
-          break;
-        case ITEM_CHECK:
-          items.push_back (
-                { new Checkpoint (renderer, item_desc.sprite_filename),
-                  ITEM_CHECK,
-                  item_desc.start_point, item_desc.start_delta,
-                  item_desc.start_point, item_desc.start_delta,
-                  true
-                });
-          break;
-        default:
-          cerr << "UNKNOWN TYPE: " << item_desc.type << endl;
-          assert (0);
+        const t_level_bin_item & bin_item = bin_items[n];
+        placeItem ((t_itemtype) bin_item.type,
+                   item_paths[bin_item.sprite_filename], bin_item.sprite_len,
+                   bin_item.sprite_start, bin_item.sprite_speed,
+                   { bin_item.x, bin_item.y }, { bin_item.dx, bin_item.dy });
       }
     }
+    for (t_item_desc & item_desc : level_data.items)
+      placeItem (item_desc.type, item_desc.sprite_filename,
+                 item_desc.sprite_len, item_desc.sprite_start,
+                 item_desc.sprite_speed, item_desc.start_point,
+                 item_desc.start_delta);
+    for (itemInfo & it : items)
+      it.item->setClock (&clock);
 
     sound_manager->playMusic(sound_bgmusic);
   }
 
+  void LevelManager::placeItem (t_itemtype type, const string & sprite_filename,
+                                int sprite_len, int sprite_start,
+                                int sprite_speed, t_point point,
+                                t_point delta)
+  {
+    DrawableItem * item;
+    switch (type)
+    {
+      case ITEM_ENEMY:
+        item = new Enemy (renderer, sprite_filename, sprite_len, sprite_start,
+                          sprite_speed);
+        break;
+      case ITEM_CHECK:
+        item = new Checkpoint (renderer, sprite_filename);
+        break;
+      default:
+        cerr << "UNKNOWN TYPE: " << type << endl;
+        assert (0);
+        return;
+    }
+    items.push_back ({ item, type, point, delta, point, delta, true });
+  }
+
+  t_item_desc LevelManager::getFileItem (Uint32 n) const
+  {
+    const t_level_bin_item & bin_item = level_file.getItems ()[n];
+    return { item_paths.find (bin_item.sprite_filename)->second,
+             bin_item.sprite_len, bin_item.sprite_start, bin_item.sprite_speed,
+             (t_itemtype) bin_item.type,
+             { bin_item.x, bin_item.y }, { bin_item.dx, bin_item.dy } };
+  }
+
+  static void put_item_desc (StateWriter & out, const t_item_desc & desc)
+  {
+    out.putString (desc.sprite_filename);
+    out.put (desc.sprite_len);
+    out.put (desc.sprite_start);
+    out.put (desc.sprite_speed);
+    out.put (desc.type);
+    out.put (desc.start_point);
+    out.put (desc.start_delta);
+  }
+
+  /* the fewest bytes put_item_desc () writes, an empty file name */
+  static const size_t item_desc_min_size = sizeof(Uint32) + 3 * sizeof(int)
+      + sizeof(t_itemtype) + 2 * sizeof(t_point);
+
+  static void get_item_desc (StateReader & in, t_item_desc & desc)
+  {
+    in.getString (desc.sprite_filename);
+    in.get (desc.sprite_len);
+    in.get (desc.sprite_start);
+    in.get (desc.sprite_speed);
+    in.get (desc.type);
+    in.get (desc.start_point);
+    in.get (desc.start_delta);
+  }
+
+  static void get_entity_state (const itemInfo & it, t_entity_state & state)
+  {
+    memset (&state, 0, sizeof(state));
+    state.type = it.type;
+    state.x = it.point.x;
+    state.y = it.point.y;
+    state.dx = it.delta.x;
+    state.dy = it.delta.y;
+    state.sub_x = it.sub_point.x;
+    state.sub_y = it.sub_point.y;
+    state.sub_dx = it.sub_delta.x;
+    state.sub_dy = it.sub_delta.y;
+    state.alive = it.alive;
+    it.item->getEntityState (state);
+  }
+
   LevelManager::LevelManager (SDL_Renderer * renderer, int level_id,
-                              vector<Player *> & v_players) :
-      renderer (renderer), level_id (level_id), player_count (v_players.size ())
+                              vector<Player *> & v_players,
+                              SoundManager * sound_manager,
+                              ThreadPool * thread_pool,
+                              const t_level_data * parsed_level) :
+      renderer (renderer), thread_pool (thread_pool),
+      sound_manager (sound_manager), profiler (0),
+      frame_arena (0), level_id (level_id),
+      player_count (v_players.size ())
   {
+    TRACE_ZONE ("LevelManager::load");
     level_surface = 0;
+    owns_surface = true;
+    frame_stats = t_level_stats ();
+
+    /* kept mapped for its collision grid and items */
+    bool compiled = open_compiled_level (level_id, level_file);
+    items_in_file = compiled
+        && level_file.getLevelData (player_count, level_data);
 
-    parse_level_file(level_id, player_count, level_data);
+    if (items_in_file)
+    {
+      const t_level_bin_item * bin_items = level_file.getItems ();
+      for (Uint32 n = 0; n < level_file.getHeader ()->item_count; n++)
+      {
+        string & path = item_paths[bin_items[n].sprite_filename];
+        if (path.empty ())
+          path = GlobalDefs::getResource (
+              RESOURCE_IMAGE,
+              level_file.getString (bin_items[n].sprite_filename));
+      }
+    }
+    else if (parsed_level)
+      level_data = *parsed_level;
+    else
+    {
+      /* the text source, the grid is still used when there is one */
+      bool level_ok = parse_level_file(level_id, player_count, level_data);
+      assert (level_ok);
+    }
 
     /* add players */
     players.reserve(player_count);
@@ -251,25 +358,134 @@ namespace jumpinjack
 
     level_width = 4000;
 
-    sound_manager = new SoundManager();
-    sound_jump  = sound_manager->loadFromFile(
-        GlobalDefs::getResource (RESOURCE_SOUND, "jump001.wav"));
-    sound_shoot = sound_manager->loadFromFile(
-        GlobalDefs::getResource (RESOURCE_SOUND, "shoot001.wav"));
-    sound_bgmusic = sound_manager->loadMusic(
-        GlobalDefs::getResource (RESOURCE_SOUND, "music001.ogg"));
-    sound_deathmusic = sound_manager->loadMusic(
-        GlobalDefs::getResource (RESOURCE_SOUND, "music002.ogg"));
-    sound_explode = sound_manager->loadFromFile(
-        GlobalDefs::getResource (RESOURCE_SOUND, "explode001.ogg"));
+    death_screen = 0;
+    scripted = false;
+    revive_pending = false;
+
+    /* everything the level needs is decoded in parallel, the textures are
+     * uploaded from loadStep () as they become ready */
+    loader = new AssetLoader (renderer, sound_manager, thread_pool);
+    loader->addSound (GlobalDefs::getResource (RESOURCE_SOUND, "jump001.wav"),
+                      &sound_jump);
+    loader->addSound (GlobalDefs::getResource (RESOURCE_SOUND, "shoot001.wav"),
+                      &sound_shoot);
+    loader->addMusic (GlobalDefs::getResource (RESOURCE_SOUND, "music001.ogg"),
+                      &sound_bgmusic);
+    loader->addMusic (GlobalDefs::getResource (RESOURCE_SOUND, "music002.ogg"),
+                      &sound_deathmusic);
+    loader->addSound (GlobalDefs::getResource (RESOURCE_SOUND, "explode001.ogg"),
+                      &sound_explode);
 
+    for (t_parallax_layer & p_layer : level_data.parallax_layers)
+      loader->addImage (p_layer.filename);
+    level_surface_data = 0;
+    if (level_file.isOpen () && level_file.getCollisionGrid ())
+      level_surface = new Surface (level_file.getCollisionGrid (),
+                                   level_file.getHeader ()->grid_width,
+                                   level_file.getHeader ()->grid_height);
+    else
+      loader->addSurface (level_data.surface_filename, &level_surface_data);
+    for (t_item_desc & item_desc : level_data.items)
+      loader->addImage (item_desc.sprite_filename);
+    for (const pair<const Uint32, string> & path : item_paths)
+      loader->addImage (path.second);
+    for (Player * player : v_players)
+      loader->addImage (player->getFilePath ());
+
+    /* spawned while playing */
+    loader->addImage (GlobalDefs::getResource (RESOURCE_IMAGE, "explosion.png"));
+    loader->addImage (GlobalDefs::getResource (RESOURCE_IMAGE, "bullet.png"));
+    loader->addImage (GlobalDefs::getResource (RESOURCE_IMAGE, "death-bg.png"));
+
+    loader->start ();
+  }
+
+  LevelManager::LevelManager (const LevelManager & loaded,
+                              vector<Player *> & v_players) :
+      renderer (loaded.renderer), thread_pool (0),
+      sound_manager (loaded.sound_manager), profiler (0),
+      frame_arena (0), level_id (loaded.level_id),
+      level_width (loaded.level_width),
+      player_count (v_players.size ()),
+      level_surface (loaded.level_surface), owns_surface (false),
+      level_surface_data (0), loader (0), level_data (loaded.level_data),
+      items_in_file (false),
+      sound_jump (loaded.sound_jump), sound_shoot (loaded.sound_shoot),
+      sound_bgmusic (loaded.sound_bgmusic),
+      sound_deathmusic (loaded.sound_deathmusic),
+      sound_explode (loaded.sound_explode), death_screen (0),
+      paused (false), alive (true), scripted (true),
+      revive_pending (false)
+  {
+    TRACE_ZONE ("LevelManager::instance");
+    assert (!loaded.loader);
+    /* the file stays with the loaded level */
+    if (loaded.items_in_file)
+    {
+      Uint32 n_items = loaded.level_file.getHeader ()->item_count;
+      level_data.items.reserve (n_items);
+      for (Uint32 n = 0; n < n_items; n++)
+        level_data.items.push_back (loaded.getFileItem (n));
+    }
+    frame_stats = t_level_stats ();
+    players.reserve (player_count);
+    for (Player * player : v_players)
+      players.push_back (
+        { player, ITEM_PLAYER,
+          { 0, 0 }, { 0, 0 },
+          { 0, 0 }, { 0, 0 } });
+  }
+
+  bool LevelManager::loadStep (size_t max_uploads)
+  {
+    TRACE_ZONE ("LevelManager::loadStep");
+    if (!loader)
+      return true;
+
+    if (!loader->poll (max_uploads))
+      return false;
+
+    delete loader;
+    loader = 0;
+
+    if (!level_surface)
+      level_surface = new Surface (level_surface_data);
+    level_surface_data = 0;
+    return true;
+  }
+
+  void LevelManager::start (void)
+  {
+    TRACE_ZONE ("LevelManager::start");
+    assert (!loader);
     loadLevelData();
 
-    death_screen = new DeathScreen(renderer);
+    /* scripted instances never show it */
+    if (!scripted)
+      death_screen = new DeathScreen(renderer);
+  }
+
+  void LevelManager::getImageAssets (set<string> & images) const
+  {
+    for (const t_parallax_layer & p_layer : level_data.parallax_layers)
+      images.insert (p_layer.filename);
+    for (const t_item_desc & item_desc : level_data.items)
+      images.insert (item_desc.sprite_filename);
+    for (const pair<const Uint32, string> & path : item_paths)
+      images.insert (path.second);
+  }
+
+  int LevelManager::getLoadProgress (void) const
+  {
+    return loader ? loader->getProgress () : 100;
   }
 
   LevelManager::~LevelManager ()
   {
+    delete loader;
+    if (level_surface_data)
+      SDL_FreeSurface (level_surface_data);
+
     for (itemInfo & it : items)
       if (it.type != ITEM_PLAYER)
         delete it.item;
@@ -277,8 +493,9 @@ namespace jumpinjack
     for (BackgroundDrawable * bg : bg_layers)
       delete bg;
 
-    delete level_surface;
-    delete sound_manager;
+    if (owns_surface)
+      delete level_surface;
+    delete death_screen;
   }
 
   void LevelManager::applyAction (int player_id, t_action action)
@@ -319,13 +536,19 @@ namespace jumpinjack
     {
       t_point point = player_info.point;
       point.y -= player->getHeight()/2;
-      t_point delta;
+      t_fixed_point velocity;
+      Projectile * shot = player->createProjectile (velocity);
+      t_point delta, sub_delta;
+      fixedSplit (velocity.x, delta.x, sub_delta.x);
+      fixedSplit (velocity.y, delta.y, sub_delta.y);
       itemInfo shoot_info =
-        { player->createProjectile(delta),
+        { shot,
           ITEM_PROJECTILE,
           point, delta,
           point, delta,
-          true };
+          true,
+          { 0, 0 }, sub_delta };
+      shoot_info.item->setClock (&clock);
       items.push_back (shoot_info);
       sound_manager->playSound(sound_shoot);
     }
@@ -339,6 +562,7 @@ namespace jumpinjack
         if ((player->jumpId < player->multipleJump ()) && !player->onJump)
         {
           player_info.delta.y = 0;
+          player_info.sub_delta.y = 0;
           player->jump();
           sound_manager->playSound(sound_jump);
         }
@@ -376,9 +600,9 @@ namespace jumpinjack
     }
   }
 
-  t_move LevelManager::canMoveTo (t_point p, ActiveDrawable * character,
-                                t_direction dir)
+  t_move LevelManager::canMoveTo (t_point p, t_dim probe, t_direction dir)
   {
+    Counters::add (COUNTER_CAN_MOVE_TO);
     pixelType pixel;
     bool move_ok = false;
     switch (dir & 0xF)
@@ -389,17 +613,17 @@ namespace jumpinjack
         move_ok = (pixel != PIXELTYPE_SOLID && pixel != PIXELTYPE_DOWN_ONLY);
         break;
       case DIRECTION_UP:
-        p.y -= character->getHeight ();
+        p.y -= probe.y;
         pixel = level_surface->testPixel (p);
         move_ok = (pixel != PIXELTYPE_SOLID && pixel != PIXELTYPE_UP_ONLY);
         break;
       case DIRECTION_LEFT:
-        p.x -= character->getWidth () / 4;
+        p.x -= probe.x;
         pixel = level_surface->testPixel (p);
         move_ok = (pixel != PIXELTYPE_SOLID);
         break;
       case DIRECTION_RIGHT:
-        p.x += character->getWidth () / 4;
+        p.x += probe.x;
         pixel = level_surface->testPixel (p);
         move_ok = (pixel != PIXELTYPE_SOLID);
         break;
@@ -421,6 +645,15 @@ namespace jumpinjack
       return (T (0) < val) - (val < T (0));
     }
 
+  /* what a contact does to the item's delta, whatever it answers */
+  static void stop_at_contact (t_direction direction, t_point & delta)
+  {
+    if (direction & DIRECTION_HORIZONTAL)
+      delta.x = 0;
+    if (direction & DIRECTION_VERTICAL)
+      delta.y = (direction & DIRECTION_UP) ? 2 : 0;
+  }
+
   t_collision LevelManager::collide(ActiveDrawable * character,
                                Drawable * item,
                                t_direction direction,
@@ -430,15 +663,12 @@ namespace jumpinjack
                                t_point * otherpoint,
                                t_point * otherdelta)
   {
+    TRACE_ZONE ("LevelManager::collide");
     t_collision collision_result = character->onCollision (item, direction,
                                                            type, point, delta,
                                                            otherpoint,
                                                            otherdelta);
-
-    if (direction & DIRECTION_HORIZONTAL)
-      delta.x = 0;
-    if (direction & DIRECTION_VERTICAL)
-      delta.y = (direction & DIRECTION_UP) ? 2 : 0;
+    stop_at_contact (direction, delta);
 
     if (collision_result != COLLISION_IGNORE)
     {
@@ -450,11 +680,13 @@ namespace jumpinjack
               renderer,
               GlobalDefs::getResource (RESOURCE_IMAGE, "explosion.png"), 11, 0,
               2, LIFESPAN_ONE_LOOP, 0);
+          explosion->setClock (&clock);
           itemInfo explosion_info =
             { explosion, ITEM_PASSIVE, point,
               { 0, 0 }, point,
               { 0, 0 }, true };
-          items.push_back (explosion_info);
+          /* items may be iterated by reference, add it after the stage */
+          spawns.push_back (explosion_info);
           collision_result = COLLISION_DIE;
           break;
         }
@@ -470,99 +702,262 @@ namespace jumpinjack
     return collision_result;
   }
 
-  bool LevelManager::detectCollision (itemInfo & it1, itemInfo & it2,
-                                      t_direction * collision_direction)
-  {
-    t_point min1 =
-      { min(it1.point.x, it1.next_point.x) - it1.item->getWidth () / 3,
-        min(it1.point.y, it1.next_point.y) - it1.item->getHeight () };
-    t_point max1 =
-      { max(it1.point.x, it1.next_point.x) + it1.item->getWidth () / 3,
-        max(it1.point.y, it1.next_point.y) };
-    t_point min2 =
-      { min(it2.point.x, it2.next_point.x) - it2.item->getWidth () / 3,
-        min(it2.point.y, it2.next_point.y) - it2.item->getHeight () };
-    t_point max2 =
-      { max(it2.point.x, it2.next_point.x) + it2.item->getWidth () / 3,
-        max(it2.point.y, it2.next_point.y) };
-
-    if (min2.x > max1.x || min1.x > max2.x || min2.y > max1.y
-        || min1.y > max2.y)
-      return false;
-    else
+  void LevelManager::buildBoxes (void)
+  {
+    TRACE_ZONE ("LevelManager::buildBoxes");
+    boxes.resize (items.size ());
+    for (size_t i = 0; i < items.size (); i++)
     {
-      t_direction hdir =
-          (it1.point.x < it2.point.x) ? DIRECTION_RIGHT : DIRECTION_LEFT;
+      const itemInfo & it = items[i];
+      /* left empty, never a candidate */
+      if (!it.item->getStatus (STATUS_LISTENING) || it.type == ITEM_PASSIVE)
+        continue;
+      boxes.set (i,
+                 min (it.point.x, it.next_point.x) - it.item->getWidth () / 3,
+                 min (it.point.y, it.next_point.y) - it.item->getHeight (),
+                 max (it.point.x, it.next_point.x) + it.item->getWidth () / 3,
+                 max (it.point.y, it.next_point.y),
+                 COLLISION_LAYER (it.type), it.item->getCollisionMask ());
+    }
+  }
 
-      *collision_direction = (t_direction) (DIRECTION_HORIZONTAL | hdir);
-      if (it1.point.y < (it2.point.y - it2.item->getHeight () / 2))
-      {
-        t_direction vdir = DIRECTION_DOWN;
-        *collision_direction = (t_direction) (*collision_direction
-            | DIRECTION_VERTICAL | vdir);
-      }
-      else if (it2.point.y < (it1.point.y - it1.item->getHeight () / 2))
-      {
-        t_direction vdir = DIRECTION_UP;
-        *collision_direction = (t_direction) (*collision_direction
-            | DIRECTION_VERTICAL | vdir);
-      }
+  t_direction LevelManager::contactDirection (const itemInfo & it1,
+                                              const itemInfo & it2) const
+  {
+    t_direction hdir =
+        (it1.point.x < it2.point.x) ? DIRECTION_RIGHT : DIRECTION_LEFT;
 
-      bool merge_points = false;
-      if (collide ((ActiveDrawable *) it1.item, it2.item, *collision_direction,
-               it2.type, it1.point, it1.delta, &it2.point,
-               &it2.delta) != COLLISION_IGNORE)
-      {
-        merge_points = true;
-        it1.alive = false;
-      }
-      if (collide ((ActiveDrawable *) it2.item, it1.item,
-               reverseDirection (*collision_direction), it1.type, it2.point,
-               it2.delta, &it1.point, &it1.delta) != COLLISION_IGNORE)
-      {
-        merge_points = true;
-        it2.alive = false;
-      }
+    t_direction collision_direction =
+        (t_direction) (DIRECTION_HORIZONTAL | hdir);
+    if (it1.point.y < (it2.point.y - it2.item->getHeight () / 2))
+    {
+      t_direction vdir = DIRECTION_DOWN;
+      collision_direction = (t_direction) (collision_direction
+          | DIRECTION_VERTICAL | vdir);
+    }
+    else if (it2.point.y < (it1.point.y - it1.item->getHeight () / 2))
+    {
+      t_direction vdir = DIRECTION_UP;
+      collision_direction = (t_direction) (collision_direction
+          | DIRECTION_VERTICAL | vdir);
+    }
+    return collision_direction;
+  }
 
-      if (merge_points)
+  void LevelManager::generateContacts (void)
+  {
+    TRACE_ZONE ("LevelManager::generateContacts");
+    size_t n_items = items.size ();
+    size_t n_chunks = 1;
+    if (thread_pool && n_items >= COLLISION_PARALLEL_MIN_ITEMS)
+      n_chunks = thread_pool->getThreadCount () * COLLISION_CHUNKS_PER_THREAD;
+
+    /* workers grow their own chunk, the arena takes concurrent
+     * allocations */
+    chunk_contacts.assign (n_chunks, ArenaVector<t_contact> (
+        ArenaAllocator<t_contact> (frame_arena)));
+    chunk_tests.assign (n_chunks, 0);
+
+    buildBoxes ();
+
+    /* read only: every chunk tests its own rows of the pair matrix */
+    auto test_rows = [this, n_items] (size_t begin, size_t end, int chunk)
       {
-        it1.next_point.x = it2.next_point.x;
-        it1.next_point.y = it2.next_point.y;
-      }
+        ArenaVector<t_contact> & found = chunk_contacts[chunk];
+        size_t tests = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+          const itemInfo & item1 = items[i];
+          if (!item1.alive || !item1.item->getStatus (STATUS_LISTENING)
+              || item1.type == ITEM_PASSIVE)
+            continue;
 
-      return true;
+          tests += n_items - i - 1;
+          for (size_t first = i + 1; first < n_items; first += AABB_BLOCK)
+          {
+            /* boxes past the end are empty, never hits */
+            uint32_t hits = boxes.overlaps (i, first);
+            while (hits)
+            {
+              size_t j = first + __builtin_ctz (hits);
+              hits &= hits - 1;
+              found.push_back ({ i, j, contactDirection (item1, items[j]) });
+            }
+          }
+        }
+        chunk_tests[chunk] = tests;
+      };
+
+    if (n_chunks > 1)
+      thread_pool->parallelFor (n_items, n_chunks, test_rows);
+    else
+      test_rows (0, n_items, 0);
+
+    /* chunks cover consecutive rows, so this keeps (a, b) order */
+    size_t n_contacts = 0;
+    for (size_t c = 0; c < n_chunks; c++)
+      n_contacts += chunk_contacts[c].size ();
+    contacts.clear ();
+    contacts.reserve (n_contacts);
+    for (size_t c = 0; c < n_chunks; c++)
+    {
+      contacts.insert (contacts.end (), chunk_contacts[c].begin (),
+                       chunk_contacts[c].end ());
+      Counters::add (COUNTER_COLLISION_TESTS, chunk_tests[c]);
     }
+    Counters::add (COUNTER_COLLISION_HITS, contacts.size ());
   }
 
-  bool LevelManager::updatePosition (itemInfo & it)
+  t_collision LevelManager::respond (itemInfo & it, itemInfo & other,
+                                     t_direction direction)
   {
-    int friction = GlobalDefs::base_friction;
-    int gravity = GlobalDefs::base_gravity;
-    it.next_delta = it.delta;
-    it.next_point = it.point;
-    it.item->update (it.next_delta);
+    t_collision_response response = RESPONSE_IGNORE;
+    if (it.item->getCollisionMask () & COLLISION_LAYER (other.type))
+      response = collisionResponse (it.type, other.type);
+    switch (response)
+    {
+      case RESPONSE_DISPATCH:
+        return collide ((ActiveDrawable *) it.item, other.item, direction,
+                        other.type, it.point, it.delta, &other.point,
+                        &other.delta);
+      case RESPONSE_DIE:
+        stop_at_contact (direction, it.delta);
+        return COLLISION_DIE;
+      default:
+        stop_at_contact (direction, it.delta);
+        return COLLISION_IGNORE;
+    }
+  }
 
-    if (!it.alive) return true;
+  void LevelManager::resolveCollision (itemInfo & it1, itemInfo & it2,
+                                       t_direction collision_direction)
+  {
+    bool merge_points = false;
+    if (respond (it1, it2, collision_direction) != COLLISION_IGNORE)
+    {
+      merge_points = true;
+      it1.alive = false;
+    }
+    if (respond (it2, it1, reverseDirection (collision_direction))
+        != COLLISION_IGNORE)
+    {
+      merge_points = true;
+      it2.alive = false;
+    }
 
-    if (it.type != ITEM_PASSIVE)
+    if (merge_points)
     {
-      gravity = (int) round(gravity * dynamic_cast<ActiveDrawable *>(it.item)->getGravityEffect());
-      ActiveDrawable * character = (ActiveDrawable *) it.item;
-      character->update (it.next_delta);
+      it1.next_point.x = it2.next_point.x;
+      it1.next_point.y = it2.next_point.y;
+    }
+  }
+
+  void LevelManager::flushSpawns (void)
+  {
+    frame_stats.spawned += spawns.size ();
+    Counters::add (COUNTER_SPAWNS, spawns.size ());
+    items.insert (items.end (), spawns.begin (), spawns.end ());
+    spawns.clear ();
+  }
+
+  /* whole pixels between a 16.16 position and where speed takes it */
+  static int pixel_steps (int point, t_fixed sub_point, t_fixed speed)
+  {
+    t_fixed from = toFixed (point) + sub_point;
+    return fixedFloor (from + speed) - point;
+  }
+
+  /* where canMoveTo () tests the surface, from the size the item has
+   * now. Drawable's sizes are not overridden, the calls are direct */
+  static t_dim move_probe (const DrawableItem * item)
+  {
+    return { item->Drawable::getWidth () / 4, item->Drawable::getHeight () };
+  }
+
+  /* what an update kernel knows of its item type when it is compiled:
+   * the class behind the items, so that their update () is a direct
+   * call, and whether they are kept inside the level */
+  template<t_itemtype TYPE>
+    struct item_kernel;
+
+  template<>
+    struct item_kernel<ITEM_PROJECTILE>
+    {
+        typedef Projectile item_class;
+        static constexpr bool bounded = false;
+    };
+
+  template<>
+    struct item_kernel<ITEM_PLAYER>
+    {
+        typedef Player item_class;
+        static constexpr bool bounded = true;
+    };
+
+  template<>
+    struct item_kernel<ITEM_ENEMY>
+    {
+        typedef Enemy item_class;
+        static constexpr bool bounded = false;
+    };
+
+  template<>
+    struct item_kernel<ITEM_CHECK>
+    {
+        typedef Checkpoint item_class;
+        static constexpr bool bounded = false;
+    };
+
+  /* passive items only animate */
+  template<>
+    bool LevelManager::updatePosition<ITEM_PASSIVE> (itemInfo & it)
+    {
+      it.next_delta = it.delta;
+      it.next_point = it.point;
+      static_cast<StaticAnimation *> (it.item)->StaticAnimation::update (
+          it.next_delta);
+      return true;
+    }
+
+  template<t_itemtype TYPE>
+    bool LevelManager::updatePosition (itemInfo & it)
+    {
+      typedef typename item_kernel<TYPE>::item_class item_class;
+      t_fixed friction = toFixed (GlobalDefs::base_friction);
+      it.next_delta = it.delta;
+      it.next_point = it.point;
+      item_class * character = static_cast<item_class *> (it.item);
+      /* twice, as the generic path always did: sprite and status timers
+       * are tuned to it */
+      character->item_class::update (it.next_delta);
+
+      if (!it.alive) return true;
+
+      character->item_class::update (it.next_delta);
+      t_dim probe = move_probe (character);
+
+      /* 16.16 speeds before and after this tick, the moves below step
+       * the whole pixels they cross */
+      t_fixed speed_x = toFixed (it.delta.x) + it.sub_delta.x;
+      t_fixed speed_y = toFixed (it.delta.y) + it.sub_delta.y;
+      t_fixed next_speed_x = toFixed (it.next_delta.x) + it.sub_delta.x;
 
       /* move horizontal */
-      if (it.next_delta.x)
+      if (next_speed_x)
       {
-        if (it.next_delta.x > 0)
-          it.next_delta.x = max (it.next_delta.x - friction, 0);
+        if (next_speed_x > 0)
+          next_speed_x = max (next_speed_x - friction, 0);
         else
-          it.next_delta.x = min (it.next_delta.x + friction, 0);
-        int inc = sgn (it.next_delta.x);
+          next_speed_x = min (next_speed_x + friction, 0);
+        fixedSplit (next_speed_x, it.next_delta.x, it.sub_delta.x);
+        int inc = sgn (next_speed_x);
         t_direction dir = (inc > 0) ? DIRECTION_RIGHT : DIRECTION_LEFT;
+        int steps = pixel_steps (it.next_point.x, it.sub_point.x, speed_x);
+        t_fixed sub_point = fixedFraction (it.sub_point.x + speed_x);
         bool goloop = true;
-        for (int i = 0; goloop && i < abs (it.delta.x); i++)
+        for (int i = 0; goloop && i < abs (steps); i++)
         {
-          t_move move_result = canMoveTo (it.next_point, character, dir);
+          t_move move_result = canMoveTo (it.next_point, probe, dir);
           switch (move_result)
           {
           case MOVE_OK:
@@ -581,13 +976,21 @@ namespace jumpinjack
               it.point = it.next_point;
               it.alive = false;
             }
+            /* collide () sets the delta, it starts from whole pixels */
+            it.sub_delta.x = 0;
+            probe = move_probe (character);
             goloop = false;
             break;
           }
         }
+        /* stopped short of the target, against a whole pixel */
+        bool reached = goloop && (!steps || sgn (steps) == inc);
+        it.sub_point.x = reached ? sub_point : 0;
 
-        if (it.type == ITEM_PLAYER)
+        if (item_kernel<TYPE>::bounded)
         {
+          if (it.next_point.x < 0 || it.next_point.x > level_width)
+            it.sub_point.x = 0;
           if (it.next_point.x < 0)
             it.next_point.x = 0;
           else if (it.next_point.x > level_width)
@@ -598,13 +1001,18 @@ namespace jumpinjack
       /* gravity */
       if (it.alive)
       {
-        t_move move_result = canMoveTo (it.next_point, character, DIRECTION_DOWN);
+        t_move move_result = canMoveTo (it.next_point, probe, DIRECTION_DOWN);
         switch (move_result)
         {
           case MOVE_OK:
-            it.next_delta.y = min (GlobalDefs::max_falling_speed, it.next_delta.y + gravity);
+          {
+            t_fixed fall = toFixed (it.next_delta.y) + it.sub_delta.y
+                + character->getGravity ();
+            fall = min (toFixed (GlobalDefs::max_falling_speed), fall);
+            fixedSplit (fall, it.next_delta.y, it.sub_delta.y);
             character->jumpId = max (1, character->jumpId);
             break;
+          }
           case MOVE_DEATH:
             it.point = it.next_point;
             it.alive = false;
@@ -616,14 +1024,18 @@ namespace jumpinjack
         }
 
         /* move vertical */
-        if (it.next_delta.y)
+        t_fixed next_speed_y = toFixed (it.next_delta.y) + it.sub_delta.y;
+        if (next_speed_y)
         {
-          int inc = sgn (it.delta.y);
+          int inc = sgn (speed_y);
           t_direction dir = (inc > 0) ? DIRECTION_DOWN : DIRECTION_UP;
+          int steps = pixel_steps (it.next_point.y, it.sub_point.y,
+                                   next_speed_y);
+          t_fixed sub_point = fixedFraction (it.sub_point.y + next_speed_y);
           bool goloop = true;
-          for (int i = 0; goloop && i < abs (it.next_delta.y); i++)
+          for (int i = 0; goloop && i < abs (steps); i++)
           {
-            t_move move_result = canMoveTo (it.next_point, character, dir);
+            t_move move_result = canMoveTo (it.next_point, probe, dir);
             switch (move_result)
             {
               case MOVE_OK:
@@ -668,26 +1080,38 @@ namespace jumpinjack
                   it.point = it.next_point;
                   it.alive = false;
                 }
+                it.sub_delta.y = 0;
                 goloop = false;
                 break;
               }
             }
           }
+          bool reached = goloop && (!steps || sgn (steps) == inc);
+          it.sub_point.y = reached ? sub_point : 0;
         } /* move vertical */
       }
       else
       {
-        it.item->onDestroy();
-        if (it.type == ITEM_PLAYER)
+        character->item_class::onDestroy ();
+        if (TYPE == ITEM_PLAYER)
         {
           sound_manager->playSound(sound_explode);
           sound_manager->playMusic(sound_deathmusic);
           return false;
         }
       }
+      return true;
+    }
+
+  template<t_itemtype TYPE>
+    bool LevelManager::updateRun (size_t begin, size_t end)
+    {
+      TRACE_ZONE ("LevelManager::updateRun");
+      bool player_alive = true;
+      for (size_t i = begin; i < end; i++)
+        player_alive &= updatePosition<TYPE> (items[i]);
+      return player_alive;
     }
-    return true;
-  }
 
   t_direction reverseDirection (t_direction dir)
   {
@@ -713,17 +1137,22 @@ namespace jumpinjack
 
   void LevelManager::update ()
   {
+    TRACE_ZONE ("LevelManager::update");
     bool player_alive = true;
+    frame_stats = t_level_stats ();
+    clock.advance ();
 
-    if (!alive)
+    if (revive_pending)
+    {
+      revive_pending = false;
+      revive ();
+    }
+    else if (!alive && !scripted)
     {
       switch (death_screen->poll ())
       {
       case MENU_CONTINUE:
-      {
-        loadLevelData ();
-        alive = true;
-      }
+        revive ();
         break;
       default:
         /* ignore */
@@ -731,57 +1160,127 @@ namespace jumpinjack
       }
     }
 
-    /* update positions */
-    for (size_t i = 0; i < items.size (); i++)
     {
-      player_alive &= updatePosition (items[i]);
-      if (!items[i].item->getStatus(STATUS_ALIVE))
+      ProfilePhase profile (profiler, PHASE_POSITION);
+
+      /* update positions, a run of items of one type at a time through
+       * that type's kernel. The list order is kept, spawns and sounds
+       * happen in it */
+      size_t n_items = items.size ();
+      for (size_t begin = 0, end; begin < n_items; begin = end)
       {
-        if (items[i].type != ITEM_PLAYER)
-          delete items[i].item;
+        t_itemtype type = items[begin].type;
+        for (end = begin + 1; end < n_items && items[end].type == type;
+            end++)
+          ;
+        switch (type)
+        {
+          case ITEM_PASSIVE:
+            player_alive &= updateRun<ITEM_PASSIVE> (begin, end);
+            break;
+          case ITEM_PROJECTILE:
+            player_alive &= updateRun<ITEM_PROJECTILE> (begin, end);
+            break;
+          case ITEM_PLAYER:
+            player_alive &= updateRun<ITEM_PLAYER> (begin, end);
+            break;
+          case ITEM_ENEMY:
+            player_alive &= updateRun<ITEM_ENEMY> (begin, end);
+            break;
+          case ITEM_CHECK:
+            player_alive &= updateRun<ITEM_CHECK> (begin, end);
+            break;
+        }
+      }
 
-        items.erase (items.begin () + i);
-        i--;
+      /* then the dead are dropped */
+      size_t kept = 0;
+      for (size_t i = 0; i < n_items; i++)
+      {
+        if (!items[i].item->getStatus(STATUS_ALIVE))
+        {
+          if (items[i].type != ITEM_PLAYER)
+            delete items[i].item;
+          frame_stats.destroyed++;
+          Counters::add (COUNTER_FREES);
+        }
+        else
+          items[kept++] = items[i];
       }
+      items.resize (kept);
+
+      flushSpawns ();
     }
 
-    /* collision detection */
-    t_direction collision_direction;
-    for (size_t i = 0; i < items.size (); i++)
     {
-      itemInfo & item1 = items[i];
+      ProfilePhase profile (profiler, PHASE_COLLISION);
 
-      if ((!item1.item->getStatus (STATUS_LISTENING)) || item1.type == ITEM_PASSIVE)
-        continue;
+      /* collision detection: contacts are generated first without touching
+       * the items, then resolved in canonical (a, b) order */
+      generateContacts ();
+      frame_stats.contacts = contacts.size ();
 
-      for (size_t j = i + 1; item1.alive && j < items.size (); j++)
+      size_t next_contact = 0;
+      for (size_t i = 0; i < items.size (); i++)
       {
-        itemInfo & item2 = items[j];
-        if ((!item2.item->getStatus (STATUS_LISTENING)) || item2.type == ITEM_PASSIVE)
+        itemInfo & item1 = items[i];
+
+        if ((!item1.item->getStatus (STATUS_LISTENING)) || item1.type == ITEM_PASSIVE)
           continue;
-        if (detectCollision (item1, item2, &collision_direction))
+
+        while (next_contact < contacts.size () && contacts[next_contact].a < i)
+          next_contact++;
+
+        for (; item1.alive && next_contact < contacts.size ()
+               && contacts[next_contact].a == i; next_contact++)
+        {
+          itemInfo & item2 = items[contacts[next_contact].b];
+          /* may have been hit by an earlier contact */
+          if (!item2.item->getStatus (STATUS_LISTENING))
+            continue;
+          resolveCollision (item1, item2, contacts[next_contact].direction);
           if (!item2.alive)
           {
             player_alive &= item2.type != ITEM_PLAYER;
             item2.item->onDestroy();
           }
+        }
+        if (!item1.alive)
+        {
+          player_alive &= item1.type != ITEM_PLAYER;
+          item1.item->onDestroy();
+        }
       }
-      if (!item1.alive)
-      {
-        player_alive &= item1.type != ITEM_PLAYER;
-        item1.item->onDestroy();
-      }
+      flushSpawns ();
     }
 
-    /* update positions */
-    for (size_t i = 0; i < items.size (); i++)
     {
-      if (!items[i].alive) continue;
+      ProfilePhase profile (profiler, PHASE_COMMIT);
+
+      /* update positions */
+      for (size_t i = 0; i < items.size (); i++)
+      {
+        if (!items[i].alive) continue;
 
-      items[i].point = items[i].next_point;
-      items[i].delta = items[i].next_delta;
+        items[i].point = items[i].next_point;
+        items[i].delta = items[i].next_delta;
+      }
+      frame_stats.items = items.size ();
+
+      uint64_t type_count[ITEM_CHECK + 1] = { 0 };
+      for (const itemInfo & it : items)
+        type_count[it.type]++;
+      for (int type = ITEM_PASSIVE; type <= ITEM_CHECK; type++)
+        Counters::set ((t_counter) (COUNTER_ITEMS_PASSIVE + type),
+                       type_count[type]);
     }
 
+    /* nothing of this frame may outlive the arena reset */
+    FrameArena::release (spawns);
+    FrameArena::release (contacts);
+    FrameArena::release (chunk_contacts);
+    FrameArena::release (chunk_tests);
+
     if (!player_alive)
     {
       sound_manager->playSound(sound_explode);
@@ -791,30 +1290,271 @@ namespace jumpinjack
     }
   }
 
+  void LevelManager::saveState (vector<Uint8> & state) const
+  {
+    TRACE_ZONE ("LevelManager::saveState");
+    state.clear ();
+    StateWriter out (state);
+    out.put (clock.now ());
+    out.put (alive);
+
+    /* the last checkpoint, where revive () goes back to */
+    out.put ((Uint32) level_data.player_start_point.size ());
+    for (size_t i = 0; i < level_data.player_start_point.size (); i++)
+    {
+      out.put (level_data.player_start_point[i]);
+      out.put (level_data.player_start_delta[i]);
+    }
+    if (items_in_file)
+    {
+      Uint32 n_items = level_file.getHeader ()->item_count;
+      out.put (n_items);
+      for (Uint32 n = 0; n < n_items; n++)
+        put_item_desc (out, getFileItem (n));
+    }
+    else
+    {
+      out.put ((Uint32) level_data.items.size ());
+      for (const t_item_desc & desc : level_data.items)
+        put_item_desc (out, desc);
+    }
+
+    /* field by field, so that consecutive keyframes line up when they are
+     * delta compressed */
+    out.put ((Uint32) items.size ());
+    for (const itemInfo & it : items)
+      out.put (it.type);
+    for (const itemInfo & it : items)
+      out.put (it.point);
+    for (const itemInfo & it : items)
+      out.put (it.delta);
+    for (const itemInfo & it : items)
+      out.put (it.next_point);
+    for (const itemInfo & it : items)
+      out.put (it.next_delta);
+    for (const itemInfo & it : items)
+      out.put (it.alive);
+    for (const itemInfo & it : items)
+      out.put (it.sub_point);
+    for (const itemInfo & it : items)
+      out.put (it.sub_delta);
+
+    /* players are kept, anything else is created again */
+    for (const itemInfo & it : items)
+    {
+      if (it.type == ITEM_PLAYER)
+      {
+        Uint32 player_id = 0;
+        while (players[player_id].item != it.item)
+          player_id++;
+        out.put (player_id);
+      }
+      else
+        put_item_desc (out,
+          { it.item->getFilePath (), it.item->getSpriteLength (),
+            it.item->getSpriteStartLine (), it.item->getSpriteFrequency (),
+            it.type, it.point, it.delta });
+    }
+    for (const itemInfo & it : items)
+      it.item->saveState (out);
+  }
+
+  DrawableItem * LevelManager::restoreItem (const t_item_desc & desc)
+  {
+    switch (desc.type)
+    {
+      case ITEM_ENEMY:
+        return new Enemy (renderer, desc.sprite_filename, desc.sprite_len,
+                          desc.sprite_start, desc.sprite_speed);
+      case ITEM_CHECK:
+        return new Checkpoint (renderer, desc.sprite_filename);
+      case ITEM_PROJECTILE:
+      {
+        /* every player shoots the same, the state sets the rest */
+        t_fixed_point velocity;
+        return ((Player *) players[0].item)->createProjectile (velocity);
+      }
+      case ITEM_PASSIVE:
+        /* explosions */
+        return new StaticAnimation (renderer, desc.sprite_filename,
+                                    desc.sprite_len, desc.sprite_start,
+                                    desc.sprite_speed, LIFESPAN_ONE_LOOP, 0);
+      default:
+        return 0;
+    }
+  }
+
+  bool LevelManager::restoreState (const vector<Uint8> & state)
+  {
+    TRACE_ZONE ("LevelManager::restoreState");
+    StateReader in (state.data (), state.size ());
+
+    t_tick now;
+    in.get (now);
+    in.get (alive);
+    paused = false;
+
+    Uint32 n_players;
+    in.get (n_players);
+    if (n_players != players.size ())
+      return false;
+    level_data.player_start_point.resize (n_players);
+    level_data.player_start_delta.resize (n_players);
+    for (Uint32 i = 0; i < n_players; i++)
+    {
+      in.get (level_data.player_start_point[i]);
+      in.get (level_data.player_start_delta[i]);
+    }
+    Uint32 n_descs;
+    in.get (n_descs);
+    if (in.failed () || n_descs > in.remaining () / item_desc_min_size)
+      return false;
+    level_data.items.resize (n_descs);
+    for (t_item_desc & desc : level_data.items)
+      get_item_desc (in, desc);
+    items_in_file = false;
+
+    Uint32 n_items;
+    in.get (n_items);
+    /* type, the six points, alive and at least a player id each */
+    const size_t item_min_size = sizeof(t_itemtype) + 6 * sizeof(t_point)
+        + sizeof(bool) + sizeof(Uint32);
+    if (in.failed () || n_items > in.remaining () / item_min_size)
+      return false;
+
+    for (itemInfo & it : items)
+      if (it.type != ITEM_PLAYER)
+        delete it.item;
+    items.assign (n_items, itemInfo ());
+    for (itemInfo & it : items)
+      in.get (it.type);
+    for (itemInfo & it : items)
+      in.get (it.point);
+    for (itemInfo & it : items)
+      in.get (it.delta);
+    for (itemInfo & it : items)
+      in.get (it.next_point);
+    for (itemInfo & it : items)
+      in.get (it.next_delta);
+    for (itemInfo & it : items)
+      in.get (it.alive);
+    for (itemInfo & it : items)
+      in.get (it.sub_point);
+    for (itemInfo & it : items)
+      in.get (it.sub_delta);
+
+    bool items_ok = !in.failed ();
+    for (itemInfo & it : items)
+    {
+      if (it.type == ITEM_PLAYER)
+      {
+        Uint32 player_id;
+        in.get (player_id);
+        if (player_id < players.size ())
+          it.item = players[player_id].item;
+      }
+      else
+      {
+        t_item_desc desc;
+        get_item_desc (in, desc);
+        if (!in.failed ())
+          it.item = restoreItem (desc);
+      }
+      items_ok &= it.item != 0;
+    }
+    if (!items_ok)
+    {
+      /* nothing half built is left behind */
+      for (itemInfo & it : items)
+        if (it.type != ITEM_PLAYER)
+          delete it.item;
+      items.clear ();
+      return false;
+    }
+
+    clock.reset (now);
+    for (itemInfo & it : items)
+    {
+      it.item->setClock (&clock);
+      it.item->loadState (in);
+    }
+
+    sound_manager->playMusic (alive ? sound_bgmusic : sound_deathmusic);
+    return !in.failed () && in.atEnd ();
+  }
+
+  Uint64 LevelManager::getStateHash (void) const
+  {
+    StateHasher hasher;
+    hasher.put (clock.now ());
+    hasher.put (alive);
+    for (size_t i = 0; i < level_data.player_start_point.size (); i++)
+    {
+      hasher.put (level_data.player_start_point[i]);
+      hasher.put (level_data.player_start_delta[i]);
+    }
+    hasher.put ((Uint32) items.size ());
+    t_entity_state state;
+    for (const itemInfo & it : items)
+    {
+      get_entity_state (it, state);
+      hasher.put (state);
+    }
+    return hasher.get ();
+  }
+
+  void LevelManager::getEntityStates (vector<t_entity_state> & states) const
+  {
+    states.resize (items.size ());
+    for (size_t i = 0; i < items.size (); i++)
+      get_entity_state (items[i], states[i]);
+  }
+
+  bool LevelManager::getPlayerState (int player_id,
+                                     t_entity_state & state) const
+  {
+    assert (player_id < player_count);
+    for (const itemInfo & it : items)
+      if (it.item == players[player_id].item)
+      {
+        get_entity_state (it, state);
+        return true;
+      }
+    memset (&state, 0, sizeof(state));
+    return false;
+  }
+
   void LevelManager::render ()
   {
+    TRACE_ZONE ("LevelManager::render");
     int xOffset =
         (items[0].point.x > GlobalDefs::window_size.x / 2) ?
         (items[0].point.x - GlobalDefs::window_size.x / 2) : 0;
     if (xOffset > (level_width - GlobalDefs::window_size.x))
       xOffset = (level_width - GlobalDefs::window_size.x);
 
-    for (BackgroundDrawable * bg : bg_layers)
     {
-      bg->renderFixed (
-        { xOffset, 0 });
+      ProfilePhase profile (profiler, PHASE_RENDER_BG);
+      for (BackgroundDrawable * bg : bg_layers)
+      {
+        bg->renderFixed (
+          { xOffset, 0 });
+      }
     }
 
-    for (itemInfo & it : items)
     {
-      int effectiveX = it.point.x - xOffset;
-
-      if (effectiveX > -it.item->getWidth ()
-          && effectiveX < (GlobalDefs::window_size.x + it.item->getWidth ()))
+      ProfilePhase profile (profiler, PHASE_RENDER_ITEMS);
+      for (itemInfo & it : items)
       {
-        t_point render_point =
-          { effectiveX, it.point.y };
-        it.item->renderFixed (render_point);
+        int effectiveX = it.point.x - xOffset;
+
+        if (effectiveX > -it.item->getWidth ()
+            && effectiveX < (GlobalDefs::window_size.x + it.item->getWidth ()))
+        {
+          t_point render_point =
+            { effectiveX, it.point.y };
+          it.item->renderFixed (render_point);
+        }
       }
     }
 
@@ -833,11 +1573,65 @@ namespace jumpinjack
 
     if (!alive)
     {
+      ProfilePhase profile (profiler, PHASE_RENDER_OVERLAY);
       death_screen->renderFixed (
         { 0, 0 });
     }
   }
 
+  void LevelManager::setProfiler (FrameProfiler * frame_profiler)
+  {
+    profiler = frame_profiler;
+  }
+
+  void LevelManager::setFrameArena (FrameArena * arena)
+  {
+    frame_arena = arena;
+    spawns = ArenaVector<itemInfo> (ArenaAllocator<itemInfo> (arena));
+    contacts = ArenaVector<t_contact> (ArenaAllocator<t_contact> (arena));
+    chunk_contacts = ArenaVector<ArenaVector<t_contact> > (
+        ArenaAllocator<ArenaVector<t_contact> > (arena));
+    chunk_tests = ArenaVector<size_t> (ArenaAllocator<size_t> (arena));
+  }
+
+  void LevelManager::getMemory (MemoryReport & report) const
+  {
+    if (level_surface && owns_surface)
+      report.add (MEMORY_COLLISION, level_data.surface_filename,
+                  level_surface->getMemorySize ());
+    for (BackgroundDrawable * bg : bg_layers)
+      bg->getMemory (report);
+
+    /* the concrete class behind every item type */
+    static const struct
+    {
+        const char * name;
+        size_t size;
+    } entity_info[ITEM_CHECK + 1] =
+      {
+        { "passive", sizeof(StaticAnimation) },
+        { "projectile", sizeof(Gunshot) },
+        { "player", sizeof(Player) },
+        { "enemy", sizeof(Enemy) },
+        { "checkpoint", sizeof(Checkpoint) } };
+    for (const itemInfo & it : items)
+    {
+      report.add (MEMORY_ENTITIES, entity_info[it.type].name,
+                  entity_info[it.type].size + sizeof(itemInfo));
+      it.item->getMemory (report);
+    }
+  }
+
+  void LevelManager::setThreadPool (ThreadPool * pool)
+  {
+    thread_pool = pool;
+  }
+
+  const t_level_stats & LevelManager::getFrameStats (void) const
+  {
+    return frame_stats;
+  }
+
   void LevelManager::pause(bool set)
   {
     if (set == paused)
@@ -847,6 +1641,27 @@ namespace jumpinjack
     sound_manager->setMusicVolume(paused?48:128);
   }
 
+  void LevelManager::revive ()
+  {
+    loadLevelData ();
+    alive = true;
+  }
+
+  void LevelManager::requestRevive (void)
+  {
+    revive_pending = true;
+  }
+
+  const SimClock & LevelManager::getClock (void) const
+  {
+    return clock;
+  }
+
+  void LevelManager::setScripted (bool set)
+  {
+    scripted = set;
+  }
+
   bool LevelManager::is_paused () const
   {
     return paused;
@@ -856,4 +1671,14 @@ namespace jumpinjack
   {
     return alive;
   }
+
+  bool LevelManager::is_finished () const
+  {
+    if (!alive)
+      return false;
+    for (const itemInfo & it : items)
+      if (it.type == ITEM_PLAYER && it.alive && it.point.x >= level_width)
+        return true;
+    return false;
+  }
 } /* namespace jumpinjack */
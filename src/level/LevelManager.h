@@ -9,47 +9,31 @@
 #define LEVEL_LEVELMANAGER_H_
 
 #include "Surface.h"
+#include "LevelFile.h"
+#include "SimClock.h"
 #include "../GlobalDefs.h"
 #include "../sdl/BackgroundDrawable.h"
 #include "../sdl/SoundManager.h"
+#include "../sdl/AssetLoader.h"
+#include "../sdl/FrameProfiler.h"
 #include "../characters/Player.h"
 #include "DeathScreen.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/FrameArena.h"
+#include "../utils/Fixed.h"
+#include "../utils/AabbSet.h"
 
-#define PARALLAX_LAYERS 3
+/* below this many items contacts are generated on the calling thread */
+#define COLLISION_PARALLEL_MIN_ITEMS 64
+#define COLLISION_CHUNKS_PER_THREAD   4
 
 #include <vector>
+#include <set>
+#include <map>
 
 namespace jumpinjack
 {
 
-  typedef struct
-  {
-    std::string filename;
-    int parallax_level;
-    bool repeat_x;
-    int parallax_speed;
-  } t_parallax_layer;
-
-  typedef struct
-  {
-    std::string sprite_filename;
-    int sprite_len;
-    int sprite_start;
-    int sprite_speed;
-    t_itemtype type;
-    t_point start_point;
-    t_point start_delta;
-  } t_item_desc;
-
-  typedef struct
-  {
-    std::vector<t_point> player_start_point;
-    std::vector<t_point> player_start_delta;
-    std::vector<t_parallax_layer> parallax_layers;
-    std::string surface_filename;
-    std::vector<t_item_desc> items;
-  } t_level_data;
-
   typedef struct
   {
       DrawableItem * item;
@@ -59,25 +43,115 @@ namespace jumpinjack
       t_point next_point;
       t_point next_delta;
       bool alive;
+      /* 16.16 fractions below point and delta, 0 to FIXED_FRACTION. Zero
+       * for whole pixel items, brace initializers may leave them out */
+      t_point sub_point;
+      t_point sub_delta;
   } itemInfo;
 
+  typedef struct
+  {
+      size_t a;               /* index of the first item, a < b */
+      size_t b;
+      t_direction direction;  /* as seen from a */
+  } t_contact;
+
+  /* what the last update () did, for the flight recorder */
+  typedef struct
+  {
+      int items;
+      int contacts;
+      int spawned;
+      int destroyed;
+  } t_level_stats;
+
   class LevelManager
   {
     public:
       LevelManager (SDL_Renderer * renderer, int level_id,
+                    std::vector<Player *> & players,
+                    SoundManager * sound_manager,
+                    ThreadPool * thread_pool = 0,
+                    const t_level_data * parsed_level = 0);
+      /* another instance of a loaded level for batched runs: the level
+       * data is copied, collision and assets are shared with it, so it
+       * must outlive this one. Scripted and ready to start () */
+      LevelManager (const LevelManager & loaded,
                     std::vector<Player *> & players);
       virtual ~LevelManager ();
 
+      /* for compiled levels (isCompiled ()) items are left empty, the
+       * constructor reads them in place from the mapped file */
+      static bool parseLevel (int level_id, int player_count,
+                              t_level_data & level_data);
+      /* the .jjl is used: valid and not older than its text source */
+      static bool isCompiled (int level_id);
+      /* compiled or text, in the pack or on disk */
+      static bool levelExists (int level_id);
+
+      /* assets are decoded in the background, call until it returns true
+       * (uploading at most max_uploads per call, 0 for no limit) and then
+       * start () the level */
+      bool loadStep (size_t max_uploads = 0);
+      int getLoadProgress (void) const;
+      void start (void);
+
+      /* level specific images, to free what the next level doesn't use */
+      void getImageAssets (std::set<std::string> & images) const;
+
       void applyAction (int player_id, t_action action);
       void update ();
       void render ();
       void pause (bool set);
       bool is_paused () const;
       bool is_alive () const;
+      /* a player reached the right edge of the level */
+      bool is_finished () const;
+      /* back to the last checkpoint, what the death screen does */
+      void revive ();
+      /* revive () at the start of the next update (), right after the
+       * clock moves, where the death screen would do it */
+      void requestRevive (void);
+      /* replays: the death screen is not polled, requestRevive () comes
+       * from the recording */
+      void setScripted (bool set);
+      /* ticks simulated so far */
+      const SimClock & getClock (void) const;
+      /* everything update () depends on: items, checkpoint and clock, for
+       * replay keyframes. Only valid for the level and build that saved
+       * it. restoreState () returns false on a corrupt state, the level
+       * has to be started again then */
+      void saveState (std::vector<Uint8> & state) const;
+      bool restoreState (const std::vector<Uint8> & state);
+      /* positions, deltas, statuses, jumps and timers of every item, plus
+       * the clock and checkpoint. Cheap enough to take every tick, to tell
+       * when two runs of a recording stop agreeing */
+      Uint64 getStateHash (void) const;
+      void getEntityStates (std::vector<t_entity_state> & states) const;
+      /* false once the player's item is gone */
+      bool getPlayerState (int player_id, t_entity_state & state) const;
+
+      /* contacts of crowded levels are generated on it, 0 for the calling
+       * thread only */
+      void setThreadPool (ThreadPool * pool);
+      /* update and render phases are timed into it when set */
+      void setProfiler (FrameProfiler * frame_profiler);
+      /* contacts and spawns live on it during update (), the heap when
+       * not set */
+      void setFrameArena (FrameArena * arena);
+      const t_level_stats & getFrameStats (void) const;
+      /* collision map, backgrounds and items */
+      void getMemory (MemoryReport & report) const;
 
     private:
-      bool updatePosition (itemInfo & it);
-      t_move canMoveTo (t_point p, ActiveDrawable * character, t_direction dir);
+      /* one kernel per item type, item_kernel in the .cpp says what
+       * each is compiled with */
+      template<t_itemtype TYPE>
+        bool updatePosition (itemInfo & it);
+      template<t_itemtype TYPE>
+        bool updateRun (size_t begin, size_t end);
+      /* probe: width / 4 and height of the item moving */
+      t_move canMoveTo (t_point p, t_dim probe, t_direction dir);
       void saveLevelData(void);
       void loadLevelData(void);
       t_collision collide(ActiveDrawable * character,
@@ -88,20 +162,58 @@ namespace jumpinjack
                           t_point & delta,
                           t_point * otherpoint = 0,
                           t_point * otherdelta = 0);
-      bool detectCollision (itemInfo & it1, itemInfo & it2,
-                            t_direction * collision_direction);
+      /* swept box and layers of every item, rows of the pair matrix
+       * are tested against it a block at a time */
+      void buildBoxes (void);
+      t_direction contactDirection (const itemInfo & it1,
+                                    const itemInfo & it2) const;
+      void generateContacts (void);
+      void resolveCollision (itemInfo & it1, itemInfo & it2,
+                             t_direction collision_direction);
+      /* its answer to touching other: from the response table, the
+       * item's onCollision () only where the table dispatches */
+      t_collision respond (itemInfo & it, itemInfo & other,
+                           t_direction direction);
+      void flushSpawns (void);
+      DrawableItem * restoreItem (const t_item_desc & desc);
+      /* an item the level places, at its start */
+      void placeItem (t_itemtype type, const std::string & sprite_filename,
+                      int sprite_len, int sprite_start, int sprite_speed,
+                      t_point point, t_point delta);
+      /* item n of the compiled level, for copies that outlive it */
+      t_item_desc getFileItem (Uint32 n) const;
       SDL_Renderer * renderer;
+      ThreadPool * thread_pool;
       SoundManager * sound_manager;
+      FrameProfiler * profiler;
+      FrameArena * frame_arena;
+      t_level_stats frame_stats;
+      SimClock clock;
 
       int level_id;
       int level_width;
       int player_count;
       std::vector<itemInfo> items;
       std::vector<itemInfo> players;
+      /* per frame, released at the end of update () */
+      ArenaVector<itemInfo> spawns;
+      ArenaVector<t_contact> contacts;
+      ArenaVector<ArenaVector<t_contact> > chunk_contacts;
+      ArenaVector<size_t> chunk_tests;
+      AabbSet boxes;
       std::vector<BackgroundDrawable *> bg_layers;
       Surface * level_surface;
+      bool owns_surface;
+      LevelFile level_file;
+      SDL_Surface * level_surface_data;
+      AssetLoader * loader;
 
       t_level_data level_data;
+      /* the level's items are read in place from level_file until a
+       * checkpoint or a restored state puts them in level_data */
+      bool items_in_file;
+      /* their sprites, resolved once per string table entry */
+      std::map<Uint32, std::string> item_paths;
 
       unsigned long sound_jump;
       unsigned long sound_shoot;
@@ -113,6 +225,8 @@ namespace jumpinjack
 
       bool paused;
       bool alive;
+      bool scripted;
+      bool revive_pending;
   };
 
 } /* namespace jumpinjack */
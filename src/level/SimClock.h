@@ -0,0 +1,70 @@
+/*
+ * SimClock.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef LEVEL_SIMCLOCK_H_
+#define LEVEL_SIMCLOCK_H_
+
+#include <SDL2/SDL.h>
+
+#include "../GlobalDefs.h"
+
+/* when the framerate is unlimited */
+#define SIM_DEFAULT_TICK_RATE 25
+
+namespace jumpinjack
+{
+
+  typedef Uint32 t_tick;
+
+  /* simulation time: LevelManager advances it once per update (), a
+   * second of play is GlobalDefs::framerate ticks. Gameplay timers count
+   * ticks so replayed and fast forwarded runs see the same time as the
+   * live one */
+  class SimClock
+  {
+    public:
+      SimClock () :
+          ticks (0)
+      {
+      }
+
+      void advance (void)
+      {
+        ++ticks;
+      }
+      t_tick now (void) const
+      {
+        return ticks;
+      }
+      /* restoring a keyframe */
+      void reset (t_tick now)
+      {
+        ticks = now;
+      }
+
+      static int getTickRate (void)
+      {
+        return GlobalDefs::framerate > 0 ?
+            GlobalDefs::framerate : SIM_DEFAULT_TICK_RATE;
+      }
+      /* rounded up, a timer never ends early */
+      static t_tick fromMillis (unsigned int millis)
+      {
+        return ((Uint64) millis * getTickRate () + 999) / 1000;
+      }
+      static unsigned int toMillis (t_tick ticks)
+      {
+        return (Uint64) ticks * 1000 / getTickRate ();
+      }
+
+    private:
+      t_tick ticks;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* LEVEL_SIMCLOCK_H_ */
@@ -6,6 +6,8 @@
  */
 
 #include "Surface.h"
+#include "../sdl/AssetPack.h"
+#include "../utils/Counters.h"
 
 #include <cassert>
 #include <iostream>
@@ -18,7 +20,7 @@ namespace jumpinjack
   Surface::Surface (
       std::string file)
   {
-    surface = IMG_Load (file.c_str ());
+    surface = IMG_Load_RW (AssetPack::openRW (file), 1);
     if (surface == NULL)
       {
         printf ("Unable to load image %s! SDL_image Error: %s\n", file.c_str (),
@@ -26,13 +28,46 @@ namespace jumpinjack
         assert(0);
       }
     pixels = (int *) surface->pixels;
+    grid = 0;
+    width = surface->w;
+    height = surface->h;
 
     offset_h = surface->h - GlobalDefs::window_size.y;
   }
 
+  Surface::Surface (
+      SDL_Surface * decoded_surface)
+  {
+    /* takes ownership of a surface decoded by the asset loader */
+    surface = decoded_surface;
+    assert(surface);
+    pixels = (int *) surface->pixels;
+    grid = 0;
+    width = surface->w;
+    height = surface->h;
+
+    offset_h = surface->h - GlobalDefs::window_size.y;
+  }
+
+  Surface::Surface (
+      const Uint8 * grid, int width, int height) :
+          surface (0), pixels (0), grid (grid), width (width), height (height)
+  {
+    assert(grid);
+    offset_h = height - GlobalDefs::window_size.y;
+  }
+
   Surface::~Surface ()
   {
-    SDL_FreeSurface (surface);
+    if (surface)
+      SDL_FreeSurface (surface);
+  }
+
+  size_t Surface::getMemorySize (void) const
+  {
+    if (surface)
+      return (size_t) surface->pitch * surface->h;
+    return (size_t) width * height;
   }
 
   int Surface::getPixel (
@@ -45,12 +80,21 @@ namespace jumpinjack
   pixelType Surface::testPixel (
       t_point p)
   {
-    int red, green, blue;
+    Counters::add (COUNTER_TEST_PIXEL);
     p.y += offset_h;
-    if (p.x < 0 || p.x >= surface->w || p.y < 0 || p.y >= surface->h)
+    if (p.x < 0 || p.x >= width || p.y < 0 || p.y >= height)
       return PIXELTYPE_OUT;
 
-    int pixel = getPixel (p);
+    if (grid)
+      return (pixelType) grid[(p.y * width) + p.x];
+
+    return classifyPixel (getPixel (p));
+  }
+
+  pixelType Surface::classifyPixel (
+      int pixel)
+  {
+    int red, green, blue;
 
     /* Get Red component */
     blue = pixel & 0xFF0000;
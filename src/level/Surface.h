@@ -28,13 +28,23 @@ namespace jumpinjack
   {
     public:
       Surface (std::string file);
+      Surface (SDL_Surface * decoded_surface);
+      /* precomputed pixel types (compiled levels), not owned */
+      Surface (const Uint8 * grid, int width, int height);
       virtual ~Surface ();
 
       int getPixel(t_point p);
       pixelType testPixel(t_point p);
+      /* compiled grids live in the level file mapping */
+      size_t getMemorySize (void) const;
+
+      static pixelType classifyPixel (int pixel);
     private:
       SDL_Surface * surface;
       int * pixels;
+      const Uint8 * grid;
+      int width;
+      int height;
 
       int offset_h;
   };
@@ -27,7 +27,7 @@ namespace jumpinjack
     onJump = 0;
     jumpId = 0;
     n_jumps = 2;
-    att_gravity_effect = 1.0;
+    setGravityEffect (FIXED_ONE);
 
     behavior_h_colision = BH_COLLISION_IGNORE_ALL;
   }
@@ -84,9 +84,14 @@ namespace jumpinjack
     return att_jump;
   }
 
-  double ActiveDrawable::getGravityEffect(void) const
+  t_fixed ActiveDrawable::getGravity (void) const
   {
-    return att_gravity_effect;
+    return att_gravity;
+  }
+
+  void ActiveDrawable::setGravityEffect (t_fixed effect)
+  {
+    att_gravity = fixedMul (effect, toFixed (GlobalDefs::base_gravity));
   }
 
   t_direction ActiveDrawable::getDirection(void) const {
@@ -106,6 +111,52 @@ namespace jumpinjack
     return n_jumps;
   }
 
+  void ActiveDrawable::saveState (StateWriter & out) const
+  {
+    DrawableItem::saveState (out);
+    out.put (onJump);
+    out.put (jumpId);
+    out.put (renderQuad);
+    out.put (direction);
+    out.put (hit_counter);
+    out.put (angle);
+    out.put (att_accel);
+    out.put (att_speed);
+    out.put (att_jump);
+    out.put (att_gravity);
+    out.put (n_jumps);
+    out.put (behavior_h_colision);
+    out.put (status_count);
+  }
+
+  void ActiveDrawable::loadState (StateReader & in)
+  {
+    DrawableItem::loadState (in);
+    in.get (onJump);
+    in.get (jumpId);
+    in.get (renderQuad);
+    in.get (direction);
+    in.get (hit_counter);
+    in.get (angle);
+    in.get (att_accel);
+    in.get (att_speed);
+    in.get (att_jump);
+    in.get (att_gravity);
+    in.get (n_jumps);
+    in.get (behavior_h_colision);
+    in.get (status_count);
+  }
+
+  void ActiveDrawable::getEntityState (t_entity_state & state) const
+  {
+    DrawableItem::getEntityState (state);
+    state.direction = direction;
+    state.on_jump = onJump;
+    state.jump_id = jumpId;
+    state.hit_counter = hit_counter;
+    state.status_count = status_count;
+  }
+
   t_collision ActiveDrawable::defaultCollisionBehavior (Drawable * item,
                                                         t_direction dir,
                                                         t_itemtype type,
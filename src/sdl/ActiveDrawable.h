@@ -9,6 +9,7 @@
 #define SDL_ACTIVEDRAWABLE_H_
 
 #include "DrawableItem.h"
+#include "../utils/Fixed.h"
 
 #include <string>
 
@@ -50,12 +51,17 @@ namespace jumpinjack
       int getAccel (void) const;
       int getSpeed (void) const;
       int getJump (void) const;
-      double getGravityEffect (void) const;
+      /* 16.16 pixels per tick added to the falling speed */
+      t_fixed getGravity (void) const;
       t_direction getDirection (void) const;
       void setDirection (t_direction dir);
       void turn (void);
       int multipleJump (void) const;
 
+      virtual void saveState (StateWriter & out) const;
+      virtual void loadState (StateReader & in);
+      virtual void getEntityState (t_entity_state & state) const;
+
       int onJump;
       int jumpId;
     protected:
@@ -67,6 +73,10 @@ namespace jumpinjack
                                             t_point * otherpoint = 0,
                                             t_point * otherdelta = 0);
 
+      /* 16.16 share of GlobalDefs::base_gravity, FIXED_ONE for all of
+       * it. Kept premultiplied in att_gravity */
+      void setGravityEffect (t_fixed effect);
+
       t_rect renderQuad;
 
       t_direction direction;
@@ -78,7 +88,7 @@ namespace jumpinjack
       int att_accel;
       int att_speed;
       int att_jump;
-      double att_gravity_effect;
+      t_fixed att_gravity;
 
       int n_jumps;
 
@@ -0,0 +1,188 @@
+/*
+ * AssetLoader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "TextureCache.h"
+#include "../utils/Tracer.h"
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  AssetLoader::AssetLoader (SDL_Renderer * renderer,
+                            SoundManager * sound_manager,
+                            ThreadPool * thread_pool) :
+      renderer (renderer), sound_manager (sound_manager),
+      thread_pool (thread_pool), loaded (0), started (false)
+  {
+  }
+
+  AssetLoader::~AssetLoader ()
+  {
+    /* workers reference the job list */
+    if (started)
+      finish ();
+  }
+
+  void AssetLoader::addImage (const string & path)
+  {
+    assert (!started);
+    if (Drawable::isCached (path) || queued_images.count (path))
+      return;
+    queued_images.insert (path);
+    jobs.push_back (
+      { ASSET_IMAGE, path, 0, 0 });
+  }
+
+  void AssetLoader::addSurface (const string & path, SDL_Surface ** surface)
+  {
+    assert (!started);
+    *surface = 0;
+    jobs.push_back (
+      { ASSET_SURFACE, path, surface, 0 });
+  }
+
+  void AssetLoader::addSound (const string & path, unsigned long * sound_id)
+  {
+    assert (!started);
+    *sound_id = sound_manager->findLoaded (path);
+    if (*sound_id || !sound_manager->audioEnabled ())
+      return;
+    jobs.push_back (
+      { ASSET_SOUND, path, sound_id, 0 });
+  }
+
+  void AssetLoader::addMusic (const string & path, unsigned long * sound_id)
+  {
+    assert (!started);
+    *sound_id = sound_manager->findLoaded (path);
+    if (*sound_id || !sound_manager->audioEnabled ())
+      return;
+    jobs.push_back (
+      { ASSET_MUSIC, path, sound_id, 0 });
+  }
+
+  void AssetLoader::start (void)
+  {
+    assert (!started);
+    started = true;
+    for (size_t i = 0; i < jobs.size (); ++i)
+    {
+      if (thread_pool)
+        thread_pool->submit ([this, i] () { decode (i); });
+      else
+        decode (i);
+    }
+  }
+
+  void AssetLoader::decode (size_t job_id)
+  {
+    TRACE_ZONE_DYNAMIC (jobs[job_id].path);
+    /* runs on a worker: nothing here may touch the renderer */
+    t_asset_job & job = jobs[job_id];
+    switch (job.type)
+    {
+      case ASSET_IMAGE:
+        job.data = TextureCache::loadImage (job.path);
+        break;
+      case ASSET_SURFACE:
+      {
+        SDL_Surface * surface = IMG_Load_RW (AssetPack::openRW (job.path), 1);
+        if (surface == NULL)
+          printf ("Unable to load image %s! SDL_image Error: %s\n",
+                  job.path.c_str (), IMG_GetError ());
+        job.data = surface;
+        break;
+      }
+      case ASSET_SOUND:
+        job.data = Mix_LoadWAV_RW (AssetPack::openRW (job.path), 1);
+        if (job.data == NULL)
+          cerr << "ERROR LOADING SOUND " << job.path << endl;
+        break;
+      case ASSET_MUSIC:
+        job.data = Mix_LoadMUS_RW (AssetPack::openRW (job.path), 1);
+        if (job.data == NULL)
+          cerr << "ERROR LOADING MUSIC " << job.path << endl;
+        break;
+    }
+
+    {
+      unique_lock<mutex> lock (decoded_mutex);
+      decoded.push_back (job_id);
+    }
+    decoded_cv.notify_one ();
+  }
+
+  void AssetLoader::upload (t_asset_job & job)
+  {
+    TRACE_ZONE ("AssetLoader::upload");
+    switch (job.type)
+    {
+      case ASSET_IMAGE:
+        if (job.data)
+          Drawable::cacheSurface (renderer, job.path,
+                                  (SDL_Surface *) job.data);
+        break;
+      case ASSET_SURFACE:
+        *((SDL_Surface **) job.target) = (SDL_Surface *) job.data;
+        break;
+      case ASSET_SOUND:
+        *((unsigned long *) job.target) =
+            sound_manager->addSound ((Mix_Chunk *) job.data, job.path);
+        break;
+      case ASSET_MUSIC:
+        *((unsigned long *) job.target) =
+            sound_manager->addMusic ((Mix_Music *) job.data, job.path);
+        break;
+    }
+    job.data = 0;
+  }
+
+  bool AssetLoader::poll (size_t max_uploads)
+  {
+    assert (started);
+    vector<size_t> ready;
+    {
+      unique_lock<mutex> lock (decoded_mutex);
+      if (max_uploads && decoded.size () > max_uploads)
+      {
+        /* leave the rest for the next call */
+        ready.assign (decoded.begin (), decoded.begin () + max_uploads);
+        decoded.erase (decoded.begin (), decoded.begin () + max_uploads);
+      }
+      else
+        ready.swap (decoded);
+    }
+
+    for (size_t job_id : ready)
+    {
+      upload (jobs[job_id]);
+      ++loaded;
+    }
+
+    return loaded == jobs.size ();
+  }
+
+  void AssetLoader::finish (void)
+  {
+    while (!poll (0))
+    {
+      unique_lock<mutex> lock (decoded_mutex);
+      decoded_cv.wait (lock, [this] { return !decoded.empty (); });
+    }
+  }
+
+  int AssetLoader::getProgress (void) const
+  {
+    if (jobs.empty ())
+      return 100;
+    return (int) (100 * loaded / jobs.size ());
+  }
+
+} /* namespace jumpinjack */
@@ -0,0 +1,82 @@
+/*
+ * AssetLoader.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_ASSETLOADER_H_
+#define SDL_ASSETLOADER_H_
+
+#include "Drawable.h"
+#include "SoundManager.h"
+#include "../utils/ThreadPool.h"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+
+namespace jumpinjack
+{
+
+  typedef enum
+  {
+    ASSET_IMAGE,    /* decoded and uploaded to the Drawable cache */
+    ASSET_SURFACE,  /* decoded only, handed over as an SDL_Surface */
+    ASSET_SOUND,
+    ASSET_MUSIC
+  } t_asset_type;
+
+  typedef struct
+  {
+      t_asset_type type;
+      std::string path;
+      void * target;  /* SDL_Surface ** or sound id */
+      void * data;    /* decoded asset, filled by the worker */
+  } t_asset_job;
+
+  /* decodes images and sounds on the thread pool, the render thread
+   * polls it to upload whatever is ready */
+  class AssetLoader
+  {
+    public:
+      AssetLoader (SDL_Renderer * renderer, SoundManager * sound_manager,
+                   ThreadPool * thread_pool);
+      virtual ~AssetLoader ();
+
+      void addImage (const std::string & path);
+      void addSurface (const std::string & path, SDL_Surface ** surface);
+      void addSound (const std::string & path, unsigned long * sound_id);
+      void addMusic (const std::string & path, unsigned long * sound_id);
+
+      void start (void);
+      /* uploads at most max_uploads decoded assets (0 means all) */
+      bool poll (size_t max_uploads = 0);
+      void finish (void);
+
+      int getProgress (void) const;
+
+    private:
+      void decode (size_t job_id);
+      void upload (t_asset_job & job);
+
+      SDL_Renderer * renderer;
+      SoundManager * sound_manager;
+      ThreadPool * thread_pool;
+
+      std::vector<t_asset_job> jobs;
+      std::set<std::string> queued_images;
+
+      std::mutex decoded_mutex;
+      std::condition_variable decoded_cv;
+      std::vector<size_t> decoded;
+
+      size_t loaded;
+      bool started;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_ASSETLOADER_H_ */
@@ -0,0 +1,210 @@
+/*
+ * AssetPack.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "AssetPack.h"
+
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  const Uint8 * AssetPack::pack_data = 0;
+  size_t AssetPack::pack_size = 0;
+
+  bool AssetPack::open (const string & path)
+  {
+    close ();
+
+    int fd = ::open (path.c_str (), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    if (fstat (fd, &st) < 0 || st.st_size < (off_t) sizeof(t_pack_header))
+    {
+      ::close (fd);
+      return false;
+    }
+
+    void * mapping = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+    if (mapping == MAP_FAILED)
+      return false;
+
+    pack_data = (const Uint8 *) mapping;
+    pack_size = st.st_size;
+
+    const t_pack_header * header = getHeader ();
+    bool pack_ok = header->magic == ASSET_PACK_MAGIC
+        && header->version == ASSET_PACK_VERSION
+        && header->index_offset <= pack_size
+        && header->entry_count
+            <= (pack_size - header->index_offset) / sizeof(t_pack_entry)
+        && header->names_offset <= pack_size
+        && header->names_size <= pack_size - header->names_offset
+        && header->names_size
+        && pack_data[header->names_offset + header->names_size - 1] == '\0';
+    for (Uint32 i = 0; pack_ok && i < header->entry_count; ++i)
+    {
+      const t_pack_entry & entry = getEntries ()[i];
+      pack_ok = entry.name < header->names_size && entry.offset <= pack_size
+          && entry.size <= pack_size - entry.offset;
+    }
+
+    if (!pack_ok)
+    {
+      cerr << "Invalid asset pack " << path << endl;
+      close ();
+      return false;
+    }
+    return true;
+  }
+
+  void AssetPack::close (void)
+  {
+    if (pack_data)
+      munmap ((void *) pack_data, pack_size);
+    pack_data = 0;
+    pack_size = 0;
+  }
+
+  bool AssetPack::isOpen (void)
+  {
+    return pack_data != 0;
+  }
+
+  const t_pack_header * AssetPack::getHeader (void)
+  {
+    return (const t_pack_header *) pack_data;
+  }
+
+  const t_pack_entry * AssetPack::getEntries (void)
+  {
+    return (const t_pack_entry *) (pack_data + getHeader ()->index_offset);
+  }
+
+  const char * AssetPack::getName (const t_pack_entry & entry)
+  {
+    return (const char *) (pack_data + getHeader ()->names_offset
+        + entry.name);
+  }
+
+  bool AssetPack::find (const string & path, const Uint8 ** data,
+                        size_t * size)
+  {
+    if (!pack_data)
+      return false;
+
+    /* index names are relative to the data directory */
+    string root = GlobalDefs::getResourceRoot ();
+    if (path.compare (0, root.size (), root) || path.size () <= root.size ()
+        || path[root.size ()] != '/')
+      return false;
+    const char * name = path.c_str () + root.size () + 1;
+
+    const t_pack_entry * entries = getEntries ();
+    const t_pack_entry * end = entries + getHeader ()->entry_count;
+    const t_pack_entry * it = lower_bound (entries, end, name,
+      [] (const t_pack_entry & entry, const char * key)
+        { return strcmp (getName (entry), key) < 0; });
+    if (it == end || strcmp (getName (*it), name))
+      return false;
+
+    *data = pack_data + it->offset;
+    *size = it->size;
+    return true;
+  }
+
+  SDL_RWops * AssetPack::openRW (const string & path)
+  {
+    const Uint8 * data;
+    size_t size;
+    if (find (path, &data, &size))
+      return SDL_RWFromConstMem (data, size);
+
+    /* development fallback */
+    return SDL_RWFromFile (path.c_str (), "rb");
+  }
+
+  static Uint32 align16 (size_t offset)
+  {
+    return (offset + 15) & ~15;
+  }
+
+  bool AssetPack::write (const string & pack_path, const string & root,
+                         const vector<string> & files)
+  {
+    vector<string> names (files);
+    sort (names.begin (), names.end ());
+
+    t_pack_header header;
+    memset (&header, 0, sizeof(header));
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.entry_count = names.size ();
+    header.index_offset = sizeof(header);
+
+    vector<char> name_table;
+    vector<t_pack_entry> entries (names.size ());
+    for (size_t i = 0; i < names.size (); ++i)
+    {
+      entries[i].name = name_table.size ();
+      name_table.insert (name_table.end (), names[i].begin (), names[i].end ());
+      name_table.push_back ('\0');
+    }
+    header.names_offset = header.index_offset
+        + entries.size () * sizeof(t_pack_entry);
+    header.names_size = name_table.size ();
+
+    /* contents */
+    vector<vector<char> > contents (names.size ());
+    size_t offset = align16 (header.names_offset + header.names_size);
+    for (size_t i = 0; i < names.size (); ++i)
+    {
+      ifstream in ((root + "/" + names[i]).c_str (), ios::binary);
+      if (!in.is_open ())
+      {
+        cerr << "Unable to read " << root << "/" << names[i] << endl;
+        return false;
+      }
+      contents[i].assign (istreambuf_iterator<char> (in),
+                          istreambuf_iterator<char> ());
+      entries[i].offset = offset;
+      entries[i].size = contents[i].size ();
+      offset = align16 (offset + contents[i].size ());
+    }
+
+    ofstream out (pack_path.c_str (), ios::binary | ios::trunc);
+    if (!out.is_open ())
+      return false;
+
+    out.write ((const char *) &header, sizeof(header));
+    out.write ((const char *) entries.data (),
+               entries.size () * sizeof(t_pack_entry));
+    out.write (name_table.data (), name_table.size ());
+
+    static const char padding[16] = { 0 };
+    size_t position = header.names_offset + header.names_size;
+    for (size_t i = 0; i < names.size (); ++i)
+    {
+      out.write (padding, entries[i].offset - position);
+      out.write (contents[i].data (), contents[i].size ());
+      position = entries[i].offset + contents[i].size ();
+    }
+    return out.good ();
+  }
+
+} /* namespace jumpinjack */
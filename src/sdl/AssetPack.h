@@ -0,0 +1,74 @@
+/*
+ * AssetPack.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_ASSETPACK_H_
+#define SDL_ASSETPACK_H_
+
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "../GlobalDefs.h"
+
+/* every resource under the data directory in a single file: header, index
+ * sorted by name (relative to the data directory), name table and the file
+ * contents, 16 byte aligned */
+#define ASSET_PACK_MAGIC    0x4B504A4A
+#define ASSET_PACK_VERSION  1
+#define ASSET_PACK_FILENAME "assets.pak"
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+      Uint32 magic;
+      Uint16 version;
+      Uint16 flags;
+      Uint32 entry_count;
+      Uint32 index_offset;
+      Uint32 names_offset;
+      Uint32 names_size;
+  } t_pack_header;
+
+  typedef struct
+  {
+      Uint32 name;    /* name table offset */
+      Uint32 offset;
+      Uint32 size;
+      Uint32 reserved;
+  } t_pack_entry;
+
+  class AssetPack
+  {
+    public:
+      static bool open (const std::string & path);
+      static void close (void);
+      static bool isOpen (void);
+
+      /* paths as returned by GlobalDefs::getResource */
+      static bool find (const std::string & path, const Uint8 ** data,
+                        size_t * size);
+      /* zero copy when the resource is packed, the loose file otherwise */
+      static SDL_RWops * openRW (const std::string & path);
+
+      static bool write (const std::string & pack_path,
+                         const std::string & root,
+                         const std::vector<std::string> & files);
+
+    private:
+      static const t_pack_header * getHeader (void);
+      static const t_pack_entry * getEntries (void);
+      static const char * getName (const t_pack_entry & entry);
+
+      static const Uint8 * pack_data;
+      static size_t pack_size;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_ASSETPACK_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "BackgroundDrawable.h"
+#include "../utils/Counters.h"
 
 using namespace std;
 
@@ -16,7 +17,7 @@ namespace jumpinjack
                                           std::string imgfile,
                                           int parallax_level, bool repeat_x,
                                           int auto_speed) :
-          Drawable (renderer, 0, false), parallax_level (parallax_level),
+          Drawable (renderer, 0, true), parallax_level (parallax_level),
           repeat_x (repeat_x), auto_speed (auto_speed)
   {
     assert(loadFromFile (imgfile));
@@ -43,6 +44,7 @@ namespace jumpinjack
           - image_size.y, image_size.x, image_size.y };
 
     //Render to screen
+    Counters::draw (mTexture);
     SDL_RenderCopyEx (renderer, mTexture, NULL, &renderQuad, 0, NULL,
                       SDL_FLIP_NONE);
 
@@ -50,6 +52,7 @@ namespace jumpinjack
       {
         renderQuad.x = -(point.x / parallax_level % image_size.x)
             + image_size.x;
+        Counters::draw (mTexture);
         SDL_RenderCopyEx (renderer, mTexture, NULL, &renderQuad, 0, NULL,
                           SDL_FLIP_NONE);
       }
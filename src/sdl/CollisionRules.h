@@ -0,0 +1,71 @@
+/*
+ * CollisionRules.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_COLLISIONRULES_H_
+#define SDL_COLLISIONRULES_H_
+
+#include "../GlobalDefs.h"
+
+#include <cstdint>
+
+/* an item's layer is the bit of its t_itemtype, its mask the layers it
+ * answers to. A pair where neither answers the other is never tested */
+#define COLLISION_LAYER(type) (1 << (type))
+
+namespace jumpinjack
+{
+
+  typedef uint8_t t_collision_mask;
+
+  typedef enum
+  {
+    RESPONSE_IGNORE,    /* COLLISION_IGNORE, nothing happens to the item */
+    RESPONSE_DIE,       /* COLLISION_DIE, nothing else happens to it */
+    RESPONSE_DISPATCH   /* depends on the item, its onCollision () says */
+  } t_collision_response;
+
+  /* how an item of the row type answers touching one of the column type,
+   * as the onCollision () of the classes behind them do. Passive items
+   * are scenery, never in contacts. Projectile rows dispatch because
+   * Projectile and Gunshot differ */
+  constexpr t_collision_response collision_responses[ITEM_CHECK + 1][ITEM_CHECK + 1] =
+    {
+      /*                PASSIVE          PROJECTILE         PLAYER             ENEMY              CHECK */
+      /* PASSIVE */    { RESPONSE_IGNORE, RESPONSE_IGNORE,   RESPONSE_IGNORE,   RESPONSE_IGNORE,   RESPONSE_IGNORE },
+      /* PROJECTILE */ { RESPONSE_IGNORE, RESPONSE_DISPATCH, RESPONSE_IGNORE,   RESPONSE_DISPATCH, RESPONSE_DISPATCH },
+      /* PLAYER */     { RESPONSE_IGNORE, RESPONSE_IGNORE,   RESPONSE_IGNORE,   RESPONSE_DISPATCH, RESPONSE_IGNORE },
+      /* ENEMY */      { RESPONSE_IGNORE, RESPONSE_DIE,      RESPONSE_DISPATCH, RESPONSE_DISPATCH, RESPONSE_IGNORE },
+      /* CHECK */      { RESPONSE_IGNORE, RESPONSE_IGNORE,   RESPONSE_DISPATCH, RESPONSE_IGNORE,   RESPONSE_IGNORE }
+    };
+
+  constexpr t_collision_response collisionResponse (t_itemtype self,
+                                                    t_itemtype other)
+  {
+    return collision_responses[self][other];
+  }
+
+  /* the layers a type answers to at all, what its items' masks start
+   * from. Items narrow it when their class or setup ignores more */
+  constexpr t_collision_mask collisionMask (t_itemtype type,
+                                            int other = ITEM_CHECK)
+  {
+    return other < 0 ? 0 :
+        (collision_responses[type][other] != RESPONSE_IGNORE ?
+            COLLISION_LAYER (other) : 0)
+            | collisionMask (type, other - 1);
+  }
+
+  static_assert (!(collisionMask (ITEM_ENEMY) & COLLISION_LAYER (ITEM_CHECK))
+                 && !(collisionMask (ITEM_CHECK)
+                     & COLLISION_LAYER (ITEM_ENEMY)),
+                 "enemies and checkpoints never meet");
+  static_assert (!collisionMask (ITEM_PASSIVE),
+                 "passive items are not in contacts");
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_COLLISIONRULES_H_ */
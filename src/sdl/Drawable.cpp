@@ -6,6 +6,9 @@
  */
 
 #include "Drawable.h"
+#include "AssetPack.h"
+#include "TextureCache.h"
+#include "../utils/Counters.h"
 
 using namespace std;
 
@@ -33,7 +36,7 @@ namespace jumpinjack
     if (!cached && mTexture)
       {
         SDL_FreeSurface (mSurface);
-        SDL_DestroyTexture (mTexture);
+        TextureCache::destroyTexture (mTexture);
         mTexture = 0;
       }
   }
@@ -57,23 +60,12 @@ namespace jumpinjack
         //The final texture
         SDL_Texture* newTexture = NULL;
 
-        //Load image at specified path
-        SDL_Surface* loadedSurface = IMG_Load (path.c_str ());
-        if (loadedSurface == NULL)
+        //Load image at specified path, colour keyed and baked
+        SDL_Surface* loadedSurface = TextureCache::loadImage (path);
+        if (loadedSurface != NULL)
           {
-            printf ("Unable to load image %s! SDL_image Error: %s\n",
-                    path.c_str (),
-                    IMG_GetError ());
-          }
-        else
-          {
-            //SDL_SetColorKey(sprite, SDL_SRCCOLORKEY | SDL_RLEACCEL, colorkey);
-            //Color key image
-            SDL_SetColorKey (loadedSurface, SDL_TRUE,
-                             SDL_MapRGB (loadedSurface->format, 0xFF, 0, 0xFF));
-
-            //Create texture from surface pixels
-            newTexture = SDL_CreateTextureFromSurface (renderer, loadedSurface);
+            //Upload the baked pixels as they are
+            newTexture = TextureCache::createTexture (renderer, loadedSurface);
             if (newTexture == NULL)
               {
                 printf ("Unable to create texture from %s! SDL Error: %s\n",
@@ -102,7 +94,7 @@ namespace jumpinjack
       //Get rid of preexisting texture
       free();
 
-      TTF_Font * gFont = TTF_OpenFont(GlobalDefs::getResource(RESOURCE_FONT, "zorque.ttf").c_str(),40);
+      TTF_Font * gFont = TTF_OpenFontRW(AssetPack::openRW(GlobalDefs::getResource(RESOURCE_FONT, "zorque.ttf")),1,40);
 
       //Render text surface
       SDL_Surface* textSurface = TTF_RenderText_Solid( gFont, textureText.c_str(), textColor );
@@ -185,6 +177,7 @@ namespace jumpinjack
       }
 
     //Render to screen
+    Counters::draw (mTexture);
     SDL_RenderCopyEx (renderer,
                       mTexture,
                       clip,
@@ -202,13 +195,74 @@ namespace jumpinjack
 
   std::map<std::string, graphicInfo> Drawable::cachedSurfaces;
 
+  bool Drawable::cacheSurface (SDL_Renderer * renderer, const string & path,
+                               SDL_Surface * surface)
+  {
+    if (isCached (path))
+      {
+        SDL_FreeSurface (surface);
+        return true;
+      }
+
+    SDL_Texture * texture = TextureCache::createTexture (renderer, surface);
+    if (texture == NULL)
+      {
+        printf ("Unable to create texture from %s! SDL Error: %s\n",
+                path.c_str (), SDL_GetError ());
+        SDL_FreeSurface (surface);
+        return false;
+      }
+    cachedSurfaces[path] =
+      { surface, texture };
+    return true;
+  }
+
+  bool Drawable::isCached (const string & path)
+  {
+    return cachedSurfaces.find (path) != cachedSurfaces.end ();
+  }
+
+  void Drawable::releaseCached (const string & path)
+  {
+    map<string, graphicInfo>::iterator it = cachedSurfaces.find (path);
+    if (it == cachedSurfaces.end ())
+      return;
+    SDL_FreeSurface (it->second.surface);
+    TextureCache::destroyTexture (it->second.texture);
+    cachedSurfaces.erase (it);
+  }
+
+  void Drawable::getMemory (MemoryReport & report) const
+  {
+    if (cached || !mTexture)
+      return;
+    string name = file_path.empty () ? "(text)" : file_path;
+    if (mSurface)
+      report.add (MEMORY_SURFACES, name,
+                  MemoryReport::getSurfaceBytes (mSurface));
+    report.add (MEMORY_TEXTURES, name,
+                TextureCache::getTextureBytes (mTexture));
+  }
+
+  void Drawable::getCacheMemory (MemoryReport & report)
+  {
+    for (map<string, graphicInfo>::iterator it = cachedSurfaces.begin ();
+        it != cachedSurfaces.end (); ++it)
+      {
+        report.add (MEMORY_SURFACES, it->first,
+                    MemoryReport::getSurfaceBytes (it->second.surface));
+        report.add (MEMORY_TEXTURES, it->first,
+                    TextureCache::getTextureBytes (it->second.texture));
+      }
+  }
+
   void Drawable::cleanCache (void)
   {
     for (map<string, graphicInfo>::iterator it = cachedSurfaces.begin ();
         it != cachedSurfaces.end (); ++it)
       {
         SDL_FreeSurface (it->second.surface);
-        SDL_DestroyTexture (it->second.texture);
+        TextureCache::destroyTexture (it->second.texture);
       }
     cachedSurfaces.clear ();
   }
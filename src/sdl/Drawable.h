@@ -15,6 +15,7 @@
 #include <SDL2/SDL_ttf.h>
 
 #include "../GlobalDefs.h"
+#include "MemoryReport.h"
 
 namespace jumpinjack
 {
@@ -57,6 +58,19 @@ namespace jumpinjack
 
       static void cleanCache (void);
 
+      /* pixels owned by this drawable, cached ones are in the cache */
+      void getMemory (MemoryReport & report) const;
+      static void getCacheMemory (MemoryReport & report);
+
+      /* used by the asset loader: the surface comes from
+       * TextureCache::loadImage elsewhere and only the texture upload
+       * happens on the render thread */
+      static bool cacheSurface (SDL_Renderer * renderer,
+                                const std::string & path,
+                                SDL_Surface * surface);
+      static bool isCached (const std::string & path);
+      static void releaseCached (const std::string & path);
+
     protected:
       std::string file_path;
       SDL_Renderer * renderer;
@@ -17,7 +17,8 @@ namespace jumpinjack
           Drawable (renderer, zindex, true), sprite_length (sprite_length),
           sprite_start_line (sprite_start_line),
           sprite_frequency (sprite_frequency), sprite_freq_divisor (0),
-          sprite_line (sprite_start_line), sprite_index (0)
+          sprite_line (sprite_start_line), sprite_index (0), clock (0),
+          spawn_tick (0), collision_mask (0)
   {
     status = (t_status) (STATUS_ALIVE | STATUS_LISTENING);
     loadFromFile (sprite_file);
@@ -65,6 +66,11 @@ namespace jumpinjack
     return sprite_frequency;
   }
 
+  t_collision_mask DrawableItem::getCollisionMask (void) const
+  {
+    return collision_mask;
+  }
+
   void DrawableItem::resetSpriteIndex ( void )
   {
     sprite_index = 0;
@@ -86,4 +92,44 @@ namespace jumpinjack
 
     return renderQuad;
   }
+
+  void DrawableItem::setClock (const SimClock * sim_clock)
+  {
+    clock = sim_clock;
+    spawn_tick = clock ? clock->now () : 0;
+  }
+
+  t_tick DrawableItem::getAge (void) const
+  {
+    return clock ? clock->now () - spawn_tick : 0;
+  }
+
+  void DrawableItem::saveState (StateWriter & out) const
+  {
+    out.put (status);
+    out.put (render_size);
+    out.put (sprite_frequency);
+    out.put (sprite_freq_divisor);
+    out.put (sprite_line);
+    out.put (sprite_index);
+    out.put (spawn_tick);
+  }
+
+  void DrawableItem::loadState (StateReader & in)
+  {
+    in.get (status);
+    in.get (render_size);
+    in.get (sprite_frequency);
+    in.get (sprite_freq_divisor);
+    in.get (sprite_line);
+    in.get (sprite_index);
+    in.get (spawn_tick);
+  }
+
+  void DrawableItem::getEntityState (t_entity_state & state) const
+  {
+    state.status = status;
+    state.age = getAge ();
+  }
+
 } /* namespace jumpinjack */
@@ -9,10 +9,36 @@
 #define SDL_DRAWABLEITEM_H_
 
 #include "Drawable.h"
+#include "CollisionRules.h"
+#include "../level/SimClock.h"
+#include "../utils/StateStream.h"
 
 namespace jumpinjack
 {
 
+  /* the simulation side of an item, what replay hashes cover and desync
+   * reports compare. Only ints, no padding to hash */
+  typedef struct
+  {
+      Sint32 type;
+      Sint32 x;
+      Sint32 y;
+      Sint32 dx;
+      Sint32 dy;
+      Sint32 sub_x;       /* 16.16 fractions of x, y, dx and dy */
+      Sint32 sub_y;
+      Sint32 sub_dx;
+      Sint32 sub_dy;
+      Sint32 alive;
+      Sint32 status;
+      Sint32 age;
+      Sint32 direction;
+      Sint32 on_jump;
+      Sint32 jump_id;
+      Sint32 hit_counter;
+      Sint32 status_count;
+  } t_entity_state;
+
   class DrawableItem : public Drawable
   {
     public:
@@ -32,6 +58,21 @@ namespace jumpinjack
 
       void resetSpriteIndex (void);
 
+      /* COLLISION_LAYER ()s of the item types it answers to, contacts with
+       * the others are not even tested. 0 for scenery */
+      t_collision_mask getCollisionMask (void) const;
+
+      /* the level's clock, the item's age counts from here */
+      void setClock (const SimClock * sim_clock);
+      t_tick getAge (void) const;
+
+      /* what update () and collisions change, for replay keyframes.
+       * Subclasses add their own after calling the parent's */
+      virtual void saveState (StateWriter & out) const;
+      virtual void loadState (StateReader & in);
+      /* fills the item's own fields, the level sets the position */
+      virtual void getEntityState (t_entity_state & state) const;
+
       virtual void onCreate (void) = 0;
       virtual void onDestroy (void) = 0;
       virtual void update (t_point & next_point) = 0;
@@ -49,6 +90,10 @@ namespace jumpinjack
       int sprite_line;
       int sprite_index;
 
+      const SimClock * clock;
+      t_tick spawn_tick;
+      t_collision_mask collision_mask;
+
     private:
       t_status status;
   };
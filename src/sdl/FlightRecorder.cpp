@@ -0,0 +1,107 @@
+/*
+ * FlightRecorder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "FlightRecorder.h"
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  FlightRecorder::FlightRecorder () :
+      next (0), count (0), frame_number (0), next_dump (0), budget_ms (0)
+  {
+  }
+
+  void FlightRecorder::setBudget (double budget)
+  {
+    budget_ms = budget;
+  }
+
+  double FlightRecorder::getBudget (void) const
+  {
+    return budget_ms;
+  }
+
+  void FlightRecorder::setDirectory (const string & path)
+  {
+    directory = path;
+    if (!directory.empty () && directory[directory.size () - 1] != '/')
+      directory += '/';
+  }
+
+  void FlightRecorder::record (const t_frame_timing & timing, int action,
+                               const t_level_stats & stats)
+  {
+    t_flight_frame & frame = frames[next];
+    frame.frame = frame_number;
+    frame.action = action;
+    frame.stats = stats;
+    frame.timing = timing;
+    next = (next + 1) % RECORDER_FRAMES;
+    if (count < RECORDER_FRAMES)
+      ++count;
+
+    double work_ms = timing.total_ms - timing.phase_ms[PHASE_WAIT];
+    if (budget_ms > 0 && work_ms > budget_ms && frame_number >= next_dump)
+    {
+      if (directory.empty ())
+      {
+        char * pref_path = SDL_GetPrefPath ("jumpinjack", "flight");
+        if (pref_path)
+        {
+          directory = pref_path;
+          SDL_free (pref_path);
+        }
+      }
+
+      stringstream path;
+      path << directory << "flight-" << time (0) << "-" << frame_number
+          << ".csv";
+      if (dump (path.str ()))
+        printf ("Frame %lu took %.2f ms (budget %.2f), last %lu frames "
+                "written to %s\n", frame_number, work_ms, budget_ms,
+                (unsigned long) count, path.str ().c_str ());
+      next_dump = frame_number + RECORDER_FRAMES;
+    }
+    ++frame_number;
+  }
+
+  bool FlightRecorder::dump (const string & path) const
+  {
+    ofstream out (path.c_str (), ios::trunc);
+    if (!out.is_open ())
+      return false;
+
+    out << "frame,action,items,contacts,spawned,destroyed";
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+      out << ',' << FrameProfiler::getPhaseName ((t_frame_phase) phase);
+    out << ",total\n";
+    out.setf (ios::fixed);
+    out.precision (3);
+
+    /* oldest first, the hitch is the last line */
+    for (size_t i = 0; i < count; ++i)
+    {
+      const t_flight_frame & frame = frames[(next + RECORDER_FRAMES - count
+          + i) % RECORDER_FRAMES];
+      out << frame.frame << ',' << frame.action << ',' << frame.stats.items
+          << ',' << frame.stats.contacts << ',' << frame.stats.spawned << ','
+          << frame.stats.destroyed;
+      for (int phase = 0; phase < PHASE_COUNT; ++phase)
+        out << ',' << frame.timing.phase_ms[phase];
+      out << ',' << frame.timing.total_ms << '\n';
+    }
+    return out.good ();
+  }
+
+} /* namespace jumpinjack */
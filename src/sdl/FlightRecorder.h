@@ -0,0 +1,62 @@
+/*
+ * FlightRecorder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_FLIGHTRECORDER_H_
+#define SDL_FLIGHTRECORDER_H_
+
+#include <string>
+
+#include "FrameProfiler.h"
+#include "../level/LevelManager.h"
+
+/* about five seconds at 25 fps */
+#define RECORDER_FRAMES 128
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+      unsigned long frame;
+      int action;
+      t_level_stats stats;
+      t_frame_timing timing;
+  } t_flight_frame;
+
+  /* always on: keeps the last RECORDER_FRAMES frames and writes them out
+   * when a frame's work goes over budget. At most one dump per window,
+   * a long hitch produces a single file */
+  class FlightRecorder
+  {
+    public:
+      FlightRecorder ();
+
+      /* ms of work (wait excluded), 0 disables the dumps */
+      void setBudget (double budget_ms);
+      double getBudget (void) const;
+      /* where dumps go, the pref path when empty */
+      void setDirectory (const std::string & path);
+
+      void record (const t_frame_timing & timing, int action,
+                   const t_level_stats & stats);
+
+      bool dump (const std::string & path) const;
+
+    private:
+      t_flight_frame frames[RECORDER_FRAMES];
+      size_t next;
+      size_t count;
+      unsigned long frame_number;
+      unsigned long next_dump;
+
+      double budget_ms;
+      std::string directory;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_FLIGHTRECORDER_H_ */
@@ -0,0 +1,175 @@
+/*
+ * FramePacer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "FramePacer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  FramePacer::FramePacer () :
+      frequency (SDL_GetPerformanceFrequency ()), period (0),
+      vsync_interval (0), spin_margin (0), frame_start (0),
+      next_deadline (0), last_present (0), history_pos (0),
+      history_count (0), late_frames (0), frame_count (0),
+      late_present (false)
+  {
+    spin_margin = fromUs (PACER_MIN_SPIN_US);
+  }
+
+  void FramePacer::setFramerate (int framerate)
+  {
+    period = framerate > 0 ? frequency / framerate : 0;
+    next_deadline = 0;
+  }
+
+  void FramePacer::setVsync (int refresh_rate)
+  {
+    vsync_interval = refresh_rate > 0 ? frequency / refresh_rate : 0;
+  }
+
+  void FramePacer::setLatePresent (bool enabled)
+  {
+    late_present = enabled;
+  }
+
+  bool FramePacer::getLatePresent (void) const
+  {
+    return late_present;
+  }
+
+  Uint64 FramePacer::fromUs (Uint64 us) const
+  {
+    return frequency * us / 1000000;
+  }
+
+  double FramePacer::toMs (Uint64 ticks) const
+  {
+    return 1000.0 * ticks / frequency;
+  }
+
+  void FramePacer::waitUntil (Uint64 counter)
+  {
+    Uint64 now = SDL_GetPerformanceCounter ();
+    if (now >= counter)
+      return;
+
+    /* sleep whole ms while far away, then spin */
+    if (counter - now > spin_margin)
+    {
+      Uint32 sleep_ms = (Uint32) ((counter - now - spin_margin) * 1000
+          / frequency);
+      if (sleep_ms)
+      {
+        Uint64 before = SDL_GetPerformanceCounter ();
+        SDL_Delay (sleep_ms);
+        Uint64 slept = SDL_GetPerformanceCounter () - before;
+
+        /* the margin follows how much the scheduler oversleeps */
+        Uint64 asked = (Uint64) sleep_ms * frequency / 1000;
+        Uint64 overshoot = slept > asked ? slept - asked : 0;
+        if (overshoot + fromUs (PACER_MIN_SPIN_US) / 2 > spin_margin)
+          spin_margin = min (overshoot + fromUs (PACER_MIN_SPIN_US) / 2,
+                             fromUs (PACER_MAX_SPIN_US));
+        else if (spin_margin > fromUs (PACER_MIN_SPIN_US))
+          spin_margin -= spin_margin / 64;
+      }
+    }
+
+    while (SDL_GetPerformanceCounter () < counter)
+      ;
+  }
+
+  void FramePacer::beginFrame (void)
+  {
+    Uint64 now = SDL_GetPerformanceCounter ();
+    if (!next_deadline)
+    {
+      next_deadline = now + period;
+      last_present = now;
+    }
+
+    if (late_present && period && history_count >= PACER_LATE_WARMUP)
+    {
+      /* start as late as the slow recent frames allow */
+      Uint64 work = fromUs ((Uint64) (getWorkTime (0.99) * 1000)
+          + PACER_LATE_MARGIN_US);
+      Uint64 present_at = next_deadline - vsync_interval / 2;
+      if (present_at > work)
+        waitUntil (present_at - work);
+    }
+
+    frame_start = SDL_GetPerformanceCounter ();
+  }
+
+  void FramePacer::waitForPresent (void)
+  {
+    Uint64 now = SDL_GetPerformanceCounter ();
+    work_ms[history_pos] = toMs (now - frame_start);
+
+    if (!period)
+      return;
+
+    if (now > next_deadline)
+      ++late_frames;
+    else
+      waitUntil (next_deadline - vsync_interval / 2);
+  }
+
+  void FramePacer::framePresented (void)
+  {
+    Uint64 now = SDL_GetPerformanceCounter ();
+    frame_ms[history_pos] = toMs (now - last_present);
+    last_present = now;
+    history_pos = (history_pos + 1) % PACER_HISTORY;
+    if (history_count < PACER_HISTORY)
+      ++history_count;
+    ++frame_count;
+
+    /* stay on the schedule, unless a long stall makes catching up
+     * pointless */
+    next_deadline += period;
+    if (now > next_deadline + period)
+      next_deadline = now + period;
+  }
+
+  double FramePacer::percentile (const double * history, double p) const
+  {
+    if (!history_count)
+      return 0;
+
+    double sorted[PACER_HISTORY];
+    copy (history, history + history_count, sorted);
+    size_t index = (size_t) (p * (history_count - 1) + 0.5);
+    nth_element (sorted, sorted + index, sorted + history_count);
+    return sorted[index];
+  }
+
+  double FramePacer::getFrameTime (double p) const
+  {
+    return percentile (frame_ms, p);
+  }
+
+  double FramePacer::getWorkTime (double p) const
+  {
+    return percentile (work_ms, p);
+  }
+
+  unsigned long FramePacer::getLateFrames (void) const
+  {
+    return late_frames;
+  }
+
+  unsigned long FramePacer::getFrameCount (void) const
+  {
+    return frame_count;
+  }
+
+} /* namespace jumpinjack */
@@ -0,0 +1,84 @@
+/*
+ * FramePacer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_FRAMEPACER_H_
+#define SDL_FRAMEPACER_H_
+
+#include <cstddef>
+#include <SDL2/SDL.h>
+
+/* frames kept for the percentiles */
+#define PACER_HISTORY      256
+/* the last stretch before a deadline is spun, SDL_Delay overshoots */
+#define PACER_MIN_SPIN_US  1000
+#define PACER_MAX_SPIN_US  4000
+/* safety margin on top of the predicted work in late present mode */
+#define PACER_LATE_MARGIN_US 1500
+/* frames measured before late present trusts the prediction */
+#define PACER_LATE_WARMUP  32
+
+namespace jumpinjack
+{
+
+  /* paces the main loop on the performance counter: the frame sleeps,
+   * spins the last part and presents on a fixed schedule. With vsync on
+   * the wait ends half a refresh early so the present lands on the
+   * vblank closest to the deadline instead of the one after it.
+   * In late present mode the wait moves to the start of the frame, so
+   * input is read as close to the present as the recent frames allow */
+  class FramePacer
+  {
+    public:
+      FramePacer ();
+
+      /* FRAMERATE_DYNAMIC runs unpaced */
+      void setFramerate (int framerate);
+      /* refresh rate of the display when presents are vsynced, 0 if not */
+      void setVsync (int refresh_rate);
+      void setLatePresent (bool enabled);
+      bool getLatePresent (void) const;
+
+      void beginFrame (void);
+      /* right before SDL_RenderPresent */
+      void waitForPresent (void);
+      /* right after it */
+      void framePresented (void);
+
+      /* over the last PACER_HISTORY frames, in ms. p in [0, 1] */
+      double getFrameTime (double p) const;
+      double getWorkTime (double p) const;
+      unsigned long getLateFrames (void) const;
+      unsigned long getFrameCount (void) const;
+
+    private:
+      void waitUntil (Uint64 counter);
+      double toMs (Uint64 ticks) const;
+      Uint64 fromUs (Uint64 us) const;
+      double percentile (const double * history, double p) const;
+
+      Uint64 frequency;
+      Uint64 period;
+      Uint64 vsync_interval;
+      Uint64 spin_margin;
+
+      Uint64 frame_start;
+      Uint64 next_deadline;
+      Uint64 last_present;
+
+      double frame_ms[PACER_HISTORY];
+      double work_ms[PACER_HISTORY];
+      size_t history_pos;
+      size_t history_count;
+
+      unsigned long late_frames;
+      unsigned long frame_count;
+      bool late_present;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_FRAMEPACER_H_ */
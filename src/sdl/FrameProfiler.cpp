@@ -0,0 +1,201 @@
+/*
+ * FrameProfiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "FrameProfiler.h"
+#include "Drawable.h"
+#include "../utils/AllocTracker.h"
+
+#include <cstring>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  static const struct
+  {
+      const char * name;
+      SDL_Color color;
+  } phase_info[PHASE_COUNT] =
+    {
+      { "events", { 0x80, 0x80, 0x80, 0xFF } },
+      { "dispatch", { 0xC0, 0xC0, 0xC0, 0xFF } },
+      { "action", { 0xFF, 0xFF, 0x00, 0xFF } },
+      { "position", { 0x00, 0xC0, 0x00, 0xFF } },
+      { "collision", { 0xFF, 0x40, 0x40, 0xFF } },
+      { "commit", { 0x00, 0xFF, 0xC0, 0xFF } },
+      { "render_bg", { 0x40, 0x40, 0xFF, 0xFF } },
+      { "render_items", { 0x80, 0x80, 0xFF, 0xFF } },
+      { "render_overlay", { 0xC0, 0x40, 0xFF, 0xFF } },
+      { "present", { 0xFF, 0x80, 0x00, 0xFF } },
+      { "wait", { 0x30, 0x30, 0x30, 0xFF } } };
+
+  FrameProfiler::FrameProfiler () :
+      frequency (SDL_GetPerformanceFrequency ()), frame_start (0),
+      history_pos (0), history_count (0), frame_number (0),
+      hud_visible (false)
+  {
+    memset (phase_start, 0, sizeof(phase_start));
+    memset (history, 0, sizeof(history));
+    memset (&current, 0, sizeof(current));
+    for (Drawable * & label : hud_labels)
+      label = 0;
+  }
+
+  FrameProfiler::~FrameProfiler ()
+  {
+    for (Drawable * label : hud_labels)
+      delete label;
+  }
+
+  const char * FrameProfiler::getPhaseName (t_frame_phase phase)
+  {
+    return phase_info[phase].name;
+  }
+
+  void FrameProfiler::beginFrame (void)
+  {
+    memset (&current, 0, sizeof(current));
+    frame_start = SDL_GetPerformanceCounter ();
+  }
+
+  void FrameProfiler::begin (t_frame_phase phase)
+  {
+    phase_start[phase] = SDL_GetPerformanceCounter ();
+    ALLOC_PHASE (phase, phase_info[phase].name);
+  }
+
+  void FrameProfiler::end (t_frame_phase phase)
+  {
+    Uint64 elapsed = SDL_GetPerformanceCounter () - phase_start[phase];
+    current.phase_ms[phase] += 1000.0f * elapsed / frequency;
+    ALLOC_PHASE (-1, 0);
+  }
+
+  void FrameProfiler::endFrame (void)
+  {
+    current.total_ms = 1000.0f * (SDL_GetPerformanceCounter () - frame_start)
+        / frequency;
+    history[history_pos] = current;
+    history_pos = (history_pos + 1) % PROFILER_HISTORY;
+    if (history_count < PROFILER_HISTORY)
+      ++history_count;
+
+    if (csv.is_open ())
+    {
+      csv << frame_number;
+      for (int phase = 0; phase < PHASE_COUNT; ++phase)
+        csv << ',' << current.phase_ms[phase];
+      csv << ',' << current.total_ms << '\n';
+    }
+    ++frame_number;
+  }
+
+  bool FrameProfiler::openCsv (const string & path)
+  {
+    csv.open (path.c_str (), ios::trunc);
+    if (!csv.is_open ())
+      return false;
+
+    csv << "frame";
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+      csv << ',' << phase_info[phase].name;
+    csv << ",total\n";
+    csv.precision (4);
+    csv << fixed;
+    return true;
+  }
+
+  void FrameProfiler::setHudVisible (bool visible)
+  {
+    hud_visible = visible;
+  }
+
+  bool FrameProfiler::isHudVisible (void) const
+  {
+    return hud_visible;
+  }
+
+  const t_frame_timing * FrameProfiler::getFrame (size_t frames_ago) const
+  {
+    if (frames_ago >= history_count)
+      return 0;
+    return &history[(history_pos + PROFILER_HISTORY - 1 - frames_ago)
+        % PROFILER_HISTORY];
+  }
+
+  void FrameProfiler::renderHud (SDL_Renderer * renderer, double budget_ms)
+  {
+    if (!hud_visible)
+      return;
+
+    int graph_height = GlobalDefs::window_size.y / 3;
+    int bottom = GlobalDefs::window_size.y - 8;
+    int left = 8;
+
+    SDL_SetRenderDrawBlendMode (renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor (renderer, 0x00, 0x00, 0x00, 0xA0);
+    t_rect panel =
+      { left - 4, bottom - graph_height - 4,
+        PROFILER_HISTORY * PROFILER_HUD_COLUMN + 8, graph_height + 8 };
+    SDL_RenderFillRect (renderer, &panel);
+
+    /* oldest on the left */
+    for (size_t i = 0; i < history_count; ++i)
+    {
+      const t_frame_timing * frame = getFrame (history_count - 1 - i);
+      int x = left + (PROFILER_HISTORY - history_count + i)
+          * PROFILER_HUD_COLUMN;
+      int y = bottom;
+      for (int phase = 0; phase < PHASE_COUNT && y > bottom - graph_height;
+          ++phase)
+      {
+        int height = (int) (frame->phase_ms[phase] * PROFILER_HUD_PX_PER_MS
+            + 0.5f);
+        if (!height)
+          continue;
+        height = min (height, y - (bottom - graph_height));
+        const SDL_Color & color = phase_info[phase].color;
+        SDL_SetRenderDrawColor (renderer, color.r, color.g, color.b, 0xFF);
+        t_rect bar =
+          { x, y - height, PROFILER_HUD_COLUMN, height };
+        SDL_RenderFillRect (renderer, &bar);
+        y -= height;
+      }
+    }
+
+    /* frame budget */
+    int budget_y = bottom - (int) (budget_ms * PROFILER_HUD_PX_PER_MS);
+    if (budget_ms > 0 && budget_y > bottom - graph_height)
+    {
+      SDL_SetRenderDrawColor (renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+      SDL_RenderDrawLine (renderer, left, budget_y,
+                          left + PROFILER_HISTORY * PROFILER_HUD_COLUMN,
+                          budget_y);
+    }
+
+    /* legend, rendered once */
+    int label_x = left + PROFILER_HISTORY * PROFILER_HUD_COLUMN + 12;
+    int label_y = bottom - graph_height;
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+      if (!hud_labels[phase])
+      {
+        hud_labels[phase] = new Drawable (renderer, 0);
+        hud_labels[phase]->loadFromRenderedText (phase_info[phase].name,
+                                                 phase_info[phase].color);
+      }
+      Drawable * label = hud_labels[phase];
+      t_dim size =
+        { label->getWidth () / 3, label->getHeight () / 3 };
+      label->render (
+        { label_x, label_y }, size);
+      label_y += size.y;
+    }
+  }
+
+} /* namespace jumpinjack */
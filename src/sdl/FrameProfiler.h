@@ -0,0 +1,111 @@
+/*
+ * FrameProfiler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_FRAMEPROFILER_H_
+#define SDL_FRAMEPROFILER_H_
+
+#include <cstddef>
+#include <string>
+#include <fstream>
+#include <SDL2/SDL.h>
+
+#define PROFILER_HISTORY  240
+/* hud graph: one column per frame, stacked by phase */
+#define PROFILER_HUD_COLUMN  2
+#define PROFILER_HUD_PX_PER_MS 3
+
+namespace jumpinjack
+{
+
+  class Drawable;
+
+  typedef enum
+  {
+    PHASE_EVENTS,
+    PHASE_DISPATCH,
+    PHASE_ACTION,
+    PHASE_POSITION,
+    PHASE_COLLISION,
+    PHASE_COMMIT,
+    PHASE_RENDER_BG,
+    PHASE_RENDER_ITEMS,
+    PHASE_RENDER_OVERLAY,
+    PHASE_PRESENT,
+    PHASE_WAIT,  /* pacer sleep, not work */
+    PHASE_COUNT
+  } t_frame_phase;
+
+  typedef struct
+  {
+      float phase_ms[PHASE_COUNT];
+      float total_ms;
+  } t_frame_timing;
+
+  /* per phase wall time of the last PROFILER_HISTORY frames. Phases may
+   * be entered several times per frame, the times add up */
+  class FrameProfiler
+  {
+    public:
+      FrameProfiler ();
+      virtual ~FrameProfiler ();
+
+      void beginFrame (void);
+      void endFrame (void);
+      void begin (t_frame_phase phase);
+      void end (t_frame_phase phase);
+
+      /* one line per frame, ms per phase */
+      bool openCsv (const std::string & path);
+
+      void setHudVisible (bool visible);
+      bool isHudVisible (void) const;
+      void renderHud (SDL_Renderer * renderer, double budget_ms);
+
+      /* 0 is the last complete frame */
+      const t_frame_timing * getFrame (size_t frames_ago) const;
+      static const char * getPhaseName (t_frame_phase phase);
+
+    private:
+      Uint64 frequency;
+      Uint64 frame_start;
+      Uint64 phase_start[PHASE_COUNT];
+
+      t_frame_timing history[PROFILER_HISTORY];
+      t_frame_timing current;
+      size_t history_pos;
+      size_t history_count;
+      unsigned long frame_number;
+
+      std::ofstream csv;
+      bool hud_visible;
+      Drawable * hud_labels[PHASE_COUNT];
+  };
+
+  /* times the enclosing scope, the profiler may be null */
+  class ProfilePhase
+  {
+    public:
+      ProfilePhase (FrameProfiler * profiler, t_frame_phase phase) :
+          profiler (profiler), phase (phase)
+      {
+        if (profiler)
+          profiler->begin (phase);
+      }
+      ~ProfilePhase ()
+      {
+        if (profiler)
+          profiler->end (phase);
+      }
+
+    private:
+      FrameProfiler * profiler;
+      t_frame_phase phase;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_FRAMEPROFILER_H_ */
@@ -0,0 +1,201 @@
+/*
+ * MemoryReport.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "MemoryReport.h"
+#include "Drawable.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  static const char * kind_names[MEMORY_KIND_COUNT] =
+    { "surfaces", "textures", "sounds", "music", "collision", "entities" };
+
+  MemoryReport::MemoryReport () :
+      sorted (true), overlay_visible (false)
+  {
+    clear ();
+    memset (shown_totals, 0, sizeof(shown_totals));
+  }
+
+  MemoryReport::~MemoryReport ()
+  {
+    freeOverlay ();
+  }
+
+  void MemoryReport::clear (void)
+  {
+    entries.clear ();
+    memset (totals, 0, sizeof(totals));
+    sorted = true;
+  }
+
+  void MemoryReport::add (t_memory_kind kind, const string & name,
+                          size_t bytes, size_t count)
+  {
+    totals[kind] += bytes;
+    for (t_memory_entry & entry : entries)
+      if (entry.kind == kind && entry.name == name)
+      {
+        entry.bytes += bytes;
+        entry.count += count;
+        sorted = false;
+        return;
+      }
+    entries.push_back (
+      { kind, name, bytes, count });
+    sorted = false;
+  }
+
+  size_t MemoryReport::getTotal (t_memory_kind kind) const
+  {
+    return totals[kind];
+  }
+
+  size_t MemoryReport::getTotal (void) const
+  {
+    size_t total = 0;
+    for (int kind = 0; kind < MEMORY_KIND_COUNT; ++kind)
+      total += totals[kind];
+    return total;
+  }
+
+  const vector<t_memory_entry> & MemoryReport::getEntries (void) const
+  {
+    return entries;
+  }
+
+  void MemoryReport::sort (void)
+  {
+    if (sorted)
+      return;
+    std::sort (entries.begin (), entries.end (),
+               [] (const t_memory_entry & a, const t_memory_entry & b)
+               {
+                 return a.bytes > b.bytes;
+               });
+    sorted = true;
+  }
+
+  void MemoryReport::print (FILE * out, const string & title) const
+  {
+    /* sorting a copy keeps print () const */
+    vector<t_memory_entry> by_size (entries);
+    std::sort (by_size.begin (), by_size.end (),
+               [] (const t_memory_entry & a, const t_memory_entry & b)
+               {
+                 return a.bytes > b.bytes;
+               });
+
+    fprintf (out, "Memory (%s): %lu KB\n", title.c_str (),
+             (unsigned long) (getTotal () / 1024));
+    for (int kind = 0; kind < MEMORY_KIND_COUNT; ++kind)
+      fprintf (out, "  %-10s %8lu KB\n", kind_names[kind],
+               (unsigned long) (totals[kind] / 1024));
+    for (const t_memory_entry & entry : by_size)
+      fprintf (out, "    %-10s %8lu KB %4lu  %s\n", kind_names[entry.kind],
+               (unsigned long) (entry.bytes / 1024),
+               (unsigned long) entry.count, entry.name.c_str ());
+  }
+
+  void MemoryReport::setOverlayVisible (bool visible)
+  {
+    overlay_visible = visible;
+  }
+
+  bool MemoryReport::isOverlayVisible (void) const
+  {
+    return overlay_visible;
+  }
+
+  void MemoryReport::freeOverlay (void)
+  {
+    for (Drawable * line : overlay_lines)
+      delete line;
+    overlay_lines.clear ();
+  }
+
+  void MemoryReport::renderOverlay (SDL_Renderer * renderer)
+  {
+    if (!overlay_visible)
+      return;
+
+    /* text is rendered again only when the numbers changed */
+    if (overlay_lines.empty ()
+        || memcmp (shown_totals, totals, sizeof(totals)))
+    {
+      freeOverlay ();
+      sort ();
+      SDL_Color color =
+        { 0xFF, 0xFF, 0xFF, 0xFF };
+      char text[128];
+      vector<string> lines;
+      snprintf (text, sizeof(text), "memory %lu KB",
+                (unsigned long) (getTotal () / 1024));
+      lines.push_back (text);
+      for (int kind = 0; kind < MEMORY_KIND_COUNT; ++kind)
+      {
+        snprintf (text, sizeof(text), "%s %lu KB", kind_names[kind],
+                  (unsigned long) (totals[kind] / 1024));
+        lines.push_back (text);
+      }
+      for (size_t i = 0; i < entries.size () && i < MEMORY_OVERLAY_ASSETS;
+          ++i)
+      {
+        const t_memory_entry & entry = entries[i];
+        snprintf (text, sizeof(text), "%lu KB %s",
+                  (unsigned long) (entry.bytes / 1024),
+                  entry.name.c_str ());
+        lines.push_back (text);
+      }
+      for (const string & line : lines)
+      {
+        Drawable * drawable = new Drawable (renderer, 0);
+        drawable->loadFromRenderedText (line, color);
+        overlay_lines.push_back (drawable);
+      }
+      memcpy (shown_totals, totals, sizeof(totals));
+    }
+
+    int x = 8;
+    int y = 8;
+    int width = 0;
+    for (Drawable * line : overlay_lines)
+      width = max (width, line->getWidth () / 3);
+    SDL_SetRenderDrawBlendMode (renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor (renderer, 0x00, 0x00, 0x00, 0xA0);
+    t_rect panel =
+      { x - 4, y - 4, width + 8, 8 };
+    for (Drawable * line : overlay_lines)
+      panel.h += line->getHeight () / 3;
+    SDL_RenderFillRect (renderer, &panel);
+
+    for (Drawable * line : overlay_lines)
+    {
+      t_dim size =
+        { line->getWidth () / 3, line->getHeight () / 3 };
+      line->render (
+        { x, y }, size);
+      y += size.y;
+    }
+  }
+
+  const char * MemoryReport::getKindName (t_memory_kind kind)
+  {
+    return kind_names[kind];
+  }
+
+  size_t MemoryReport::getSurfaceBytes (const SDL_Surface * surface)
+  {
+    return surface ? (size_t) surface->pitch * surface->h : 0;
+  }
+
+} /* namespace jumpinjack */
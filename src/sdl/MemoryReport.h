@@ -0,0 +1,87 @@
+/*
+ * MemoryReport.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_MEMORYREPORT_H_
+#define SDL_MEMORYREPORT_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+/* overlay lines after the per kind totals */
+#define MEMORY_OVERLAY_ASSETS 6
+/* frames between overlay refreshes */
+#define MEMORY_OVERLAY_REFRESH 60
+
+namespace jumpinjack
+{
+
+  class Drawable;
+
+  typedef enum
+  {
+    MEMORY_SURFACES,   /* decoded pixels kept in RAM */
+    MEMORY_TEXTURES,   /* estimated from format and size */
+    MEMORY_SOUNDS,
+    MEMORY_MUSIC,      /* streamed, the compressed source */
+    MEMORY_COLLISION,
+    MEMORY_ENTITIES,
+    MEMORY_KIND_COUNT
+  } t_memory_kind;
+
+  typedef struct
+  {
+      t_memory_kind kind;
+      std::string name;
+      size_t bytes;
+      size_t count;
+  } t_memory_entry;
+
+  /* bytes by subsystem and asset. Owners add what they hold through
+   * their getMemory (MemoryReport &) */
+  class MemoryReport
+  {
+    public:
+      MemoryReport ();
+      virtual ~MemoryReport ();
+
+      void clear (void);
+      /* entries with the same kind and name add up */
+      void add (t_memory_kind kind, const std::string & name, size_t bytes,
+                size_t count = 1);
+
+      size_t getTotal (t_memory_kind kind) const;
+      size_t getTotal (void) const;
+      const std::vector<t_memory_entry> & getEntries (void) const;
+
+      /* totals and every asset, largest first */
+      void print (FILE * out, const std::string & title) const;
+
+      void setOverlayVisible (bool visible);
+      bool isOverlayVisible (void) const;
+      void renderOverlay (SDL_Renderer * renderer);
+
+      static const char * getKindName (t_memory_kind kind);
+      static size_t getSurfaceBytes (const SDL_Surface * surface);
+
+    private:
+      void sort (void);
+      void freeOverlay (void);
+
+      std::vector<t_memory_entry> entries;
+      size_t totals[MEMORY_KIND_COUNT];
+      bool sorted;
+
+      bool overlay_visible;
+      size_t shown_totals[MEMORY_KIND_COUNT];
+      std::vector<Drawable *> overlay_lines;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_MEMORYREPORT_H_ */
@@ -0,0 +1,317 @@
+/*
+ * Replay.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "Replay.h"
+#include "../utils/Lz.h"
+#include "../utils/Tracer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  /* keyframes are stored as the difference to the previous one: most of
+   * the level does not change in a few seconds, the xor is mostly zeros.
+   * The same call undoes it */
+  static void xor_keyframe (const Uint8 * state, size_t state_size,
+                            const vector<Uint8> & base, vector<Uint8> & out)
+  {
+    out.assign (state, state + state_size);
+    size_t common = min (state_size, base.size ());
+    for (size_t i = 0; i < common; i++)
+      out[i] ^= base[i];
+  }
+
+  /* what the file has after the read position */
+  static size_t bytes_left (istream & in)
+  {
+    streampos pos = in.tellg ();
+    in.seekg (0, ios::end);
+    streampos end = in.tellg ();
+    in.seekg (pos);
+    if (pos < 0 || end < pos)
+      return 0;
+    return end - pos;
+  }
+
+  ReplayRecorder::ReplayRecorder () :
+      recording (false), hashing (false)
+  {
+  }
+
+  ReplayRecorder::~ReplayRecorder ()
+  {
+    if (recording)
+      close ();
+  }
+
+  void ReplayRecorder::open (const string & replay_path, int level_id,
+                             unsigned int seed, Uint32 keyframe_interval,
+                             bool hashes)
+  {
+    path = replay_path;
+    replay.level_id = level_id;
+    replay.seed = seed;
+    replay.framerate = GlobalDefs::framerate;
+    replay.ticks.clear ();
+    replay.revives.clear ();
+    replay.keyframe_interval = keyframe_interval;
+    replay.keyframes.clear ();
+    replay.keyframe_data.clear ();
+    last_keyframe.clear ();
+    replay.hashes.clear ();
+    hashing = hashes;
+    /* an hour of play, so recording does not grow the buffer */
+    size_t hour = 3600 * (GlobalDefs::framerate > 0 ?
+        GlobalDefs::framerate : 60);
+    replay.ticks.reserve (hour);
+    if (hashing)
+      replay.hashes.reserve (hour);
+    recording = true;
+  }
+
+  bool ReplayRecorder::isOpen (void) const
+  {
+    return recording;
+  }
+
+  void ReplayRecorder::record (t_action action, bool paused, bool revived)
+  {
+    if (!recording)
+      return;
+    if (revived)
+      replay.revives.push_back (replay.ticks.size ());
+    replay.ticks.push_back ((action & TICK_ACTION_MASK)
+        | (paused ? TICK_PAUSED : 0));
+  }
+
+  bool ReplayRecorder::isHashing (void) const
+  {
+    return recording && hashing;
+  }
+
+  void ReplayRecorder::recordHash (Uint64 hash)
+  {
+    assert (replay.hashes.size () + 1 == replay.ticks.size ());
+    replay.hashes.push_back (hash);
+  }
+
+  bool ReplayRecorder::keyframeDue (void) const
+  {
+    Uint32 tick = replay.ticks.size ();
+    return recording && replay.keyframe_interval && tick
+        && !(tick % replay.keyframe_interval)
+        && (replay.keyframes.empty () || replay.keyframes.back ().tick != tick);
+  }
+
+  void ReplayRecorder::addKeyframe (const vector<Uint8> & state)
+  {
+    TRACE_ZONE ("ReplayRecorder::addKeyframe");
+    t_keyframe_index index;
+    index.tick = replay.ticks.size ();
+    index.offset = replay.keyframe_data.size ();
+    index.state_size = state.size ();
+    index.delta = replay.keyframes.size () % REPLAY_FULL_KEYFRAME != 0;
+
+    if (index.delta)
+    {
+      xor_keyframe (state.data (), state.size (), last_keyframe,
+                    keyframe_delta);
+      lzCompress (keyframe_delta.data (), keyframe_delta.size (),
+                  replay.keyframe_data);
+    }
+    else
+      lzCompress (state.data (), state.size (), replay.keyframe_data);
+    index.packed_size = replay.keyframe_data.size () - index.offset;
+    replay.keyframes.push_back (index);
+    last_keyframe = state;
+  }
+
+  bool ReplayRecorder::close (void)
+  {
+    recording = false;
+    bool saved = Replay::save (path, replay);
+    if (saved)
+      printf ("Recorded %lu ticks and %lu keyframes (%lu KB) to %s\n",
+              (unsigned long) replay.ticks.size (),
+              (unsigned long) replay.keyframes.size (),
+              (unsigned long) (replay.keyframe_data.size () / 1024),
+              path.c_str ());
+    else
+      printf ("Unable to write replay %s\n", path.c_str ());
+    return saved;
+  }
+
+  bool Replay::save (const string & path, const t_replay & replay)
+  {
+    /* ticks then revive ticks, packed together */
+    vector<Uint8> raw (replay.ticks);
+    size_t revives_offset = raw.size ();
+    raw.resize (revives_offset + replay.revives.size () * sizeof(Uint32));
+    if (!replay.revives.empty ())
+      memcpy (raw.data () + revives_offset, replay.revives.data (),
+              replay.revives.size () * sizeof(Uint32));
+    vector<Uint8> packed;
+    lzCompress (raw.data (), raw.size (), packed);
+
+    t_replay_header header;
+    header.magic = REPLAY_MAGIC;
+    header.version = REPLAY_VERSION;
+    header.level_id = replay.level_id;
+    header.seed = replay.seed;
+    header.framerate = replay.framerate;
+    header.tick_count = replay.ticks.size ();
+    header.revive_count = replay.revives.size ();
+    header.packed_size = packed.size ();
+    header.keyframe_interval = replay.keyframe_interval;
+    header.keyframe_count = replay.keyframes.size ();
+    header.hash_count = replay.hashes.size ();
+
+    ofstream out (path.c_str (), ios::binary | ios::trunc);
+    if (!out.is_open ())
+      return false;
+    out.write ((const char *) &header, sizeof(header));
+    out.write ((const char *) packed.data (), packed.size ());
+    out.write ((const char *) replay.keyframes.data (),
+               replay.keyframes.size () * sizeof(t_keyframe_index));
+    out.write ((const char *) replay.keyframe_data.data (),
+               replay.keyframe_data.size ());
+    out.write ((const char *) replay.hashes.data (),
+               replay.hashes.size () * sizeof(Uint64));
+    out.close ();
+    return out.good ();
+  }
+
+  bool Replay::load (const string & path, t_replay & replay)
+  {
+    ifstream in (path.c_str (), ios::binary);
+    if (!in.is_open ())
+      return false;
+
+    /* older versions end the header before the fields they lack */
+    t_replay_header header;
+    memset (&header, 0, sizeof(header));
+    const size_t v1_size = offsetof (t_replay_header, keyframe_interval);
+    if (!in.read ((char *) &header, v1_size)
+        || header.magic != REPLAY_MAGIC
+        || header.version < 1 || header.version > REPLAY_VERSION)
+      return false;
+    size_t header_size = sizeof(header);
+    if (header.version == 1)
+      header_size = v1_size;
+    else if (header.version == 2)
+      header_size = offsetof (t_replay_header, hash_count);
+    if (!in.read ((char *) &header + v1_size, header_size - v1_size))
+      return false;
+    if (header.hash_count && header.hash_count != header.tick_count)
+      return false;
+
+    /* sizes are checked before anything is allocated for them, a corrupt
+     * header fails the load */
+    size_t raw_size = header.tick_count
+        + (size_t) header.revive_count * sizeof(Uint32);
+    if (header.packed_size > bytes_left (in)
+        || raw_size > (size_t) header.packed_size * LZ_MAX_EXPANSION)
+      return false;
+    vector<Uint8> packed (header.packed_size);
+    vector<Uint8> raw (raw_size);
+    if (!in.read ((char *) packed.data (), packed.size ())
+        || !lzDecompress (packed.data (), packed.size (), raw.data (),
+                          raw_size))
+      return false;
+
+    replay.level_id = header.level_id;
+    replay.seed = header.seed;
+    replay.framerate = header.framerate;
+    replay.ticks.assign (raw.begin (), raw.begin () + header.tick_count);
+    replay.revives.resize (header.revive_count);
+    if (header.revive_count)
+      memcpy (replay.revives.data (), raw.data () + header.tick_count,
+              header.revive_count * sizeof(Uint32));
+
+    replay.keyframe_interval = header.keyframe_interval;
+    if ((size_t) header.keyframe_count * sizeof(t_keyframe_index)
+        + (size_t) header.hash_count * sizeof(Uint64) > bytes_left (in))
+      return false;
+    replay.keyframes.resize (header.keyframe_count);
+    if (header.keyframe_count
+        && !in.read ((char *) replay.keyframes.data (),
+                     header.keyframe_count * sizeof(t_keyframe_index)))
+      return false;
+    size_t data_size = 0;
+    for (const t_keyframe_index & index : replay.keyframes)
+    {
+      /* getKeyframe () sizes its buffer from state_size */
+      if (index.state_size > (size_t) index.packed_size * LZ_MAX_EXPANSION)
+        return false;
+      data_size = max (data_size, (size_t) index.offset + index.packed_size);
+    }
+    if (data_size > bytes_left (in))
+      return false;
+    replay.keyframe_data.resize (data_size);
+    if (data_size
+        && !in.read ((char *) replay.keyframe_data.data (), data_size))
+      return false;
+    replay.hashes.resize (header.hash_count);
+    if (header.hash_count
+        && !in.read ((char *) replay.hashes.data (),
+                     header.hash_count * sizeof(Uint64)))
+      return false;
+    return true;
+  }
+
+  int Replay::findKeyframe (const t_replay & replay, Uint32 tick)
+  {
+    int found = -1;
+    for (size_t k = 0; k < replay.keyframes.size ()
+        && replay.keyframes[k].tick <= tick; k++)
+      found = k;
+    return found;
+  }
+
+  bool Replay::getKeyframe (const t_replay & replay, int keyframe,
+                            vector<Uint8> & state)
+  {
+    TRACE_ZONE ("Replay::getKeyframe");
+    if (keyframe < 0 || keyframe >= (int) replay.keyframes.size ())
+      return false;
+
+    /* back to the keyframe the chain starts from */
+    int first = keyframe;
+    while (first > 0 && replay.keyframes[first].delta)
+      first--;
+
+    vector<Uint8> raw;
+    state.clear ();
+    for (int k = first; k <= keyframe; k++)
+    {
+      const t_keyframe_index & index = replay.keyframes[k];
+      if ((size_t) index.offset + index.packed_size
+          > replay.keyframe_data.size ())
+        return false;
+      raw.resize (index.state_size);
+      if (!lzDecompress (replay.keyframe_data.data () + index.offset,
+                         index.packed_size, raw.data (), raw.size ()))
+        return false;
+      if (k == first)
+        state.swap (raw);
+      else
+      {
+        vector<Uint8> base;
+        base.swap (state);
+        xor_keyframe (raw.data (), raw.size (), base, state);
+      }
+    }
+    return true;
+  }
+
+} /* namespace jumpinjack */
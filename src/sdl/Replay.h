@@ -0,0 +1,124 @@
+/*
+ * Replay.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_REPLAY_H_
+#define SDL_REPLAY_H_
+
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "../GlobalDefs.h"
+
+/* .jjr: header followed by the tick stream, lz compressed. Actions
+ * hardly change from tick to tick, so it packs very well. Version 2 adds
+ * the keyframe index and the keyframes after it, version 3 the optional
+ * per tick state hashes at the end */
+#define REPLAY_MAGIC   0x524A4A4A  /* "JJJR" */
+#define REPLAY_VERSION 3
+
+/* level state every this many ticks, to seek without playing from the
+ * start. Keyframes are xor'ed with the previous one before compressing,
+ * every REPLAY_FULL_KEYFRAME-th one stands alone so seeking decodes a
+ * bounded chain */
+#define REPLAY_KEYFRAME_INTERVAL 250
+#define REPLAY_FULL_KEYFRAME     8
+
+/* one byte per tick: the t_action bits and what the level did */
+#define TICK_ACTION_MASK 0x7F
+#define TICK_PAUSED      0x80   /* applied, but the level did not update */
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+      Uint32 magic;
+      Uint32 version;
+      Uint32 level_id;
+      Uint32 seed;
+      Uint32 framerate;
+      Uint32 tick_count;
+      Uint32 revive_count;
+      Uint32 packed_size;
+      /* version 2 */
+      Uint32 keyframe_interval;
+      Uint32 keyframe_count;
+      /* version 3 */
+      Uint32 hash_count;
+  } t_replay_header;
+
+  typedef struct
+  {
+      Uint32 tick;         /* state before this tick is applied */
+      Uint32 offset;       /* into the keyframe data */
+      Uint32 packed_size;
+      Uint32 state_size;
+      Uint32 delta;        /* xor'ed with the previous keyframe */
+  } t_keyframe_index;
+
+  typedef struct
+  {
+      int level_id;
+      unsigned int seed;
+      int framerate;
+      std::vector<Uint8> ticks;
+      /* ticks where the death screen let the player continue, ascending */
+      std::vector<Uint32> revives;
+      Uint32 keyframe_interval;
+      std::vector<t_keyframe_index> keyframes;
+      /* still compressed, decoded by Replay::getKeyframe () */
+      std::vector<Uint8> keyframe_data;
+      /* LevelManager::getStateHash () after each tick, if recorded */
+      std::vector<Uint64> hashes;
+  } t_replay;
+
+  /* collects the ticks of a session and writes them on close () */
+  class ReplayRecorder
+  {
+    public:
+      ReplayRecorder ();
+      virtual ~ReplayRecorder ();
+
+      void open (const std::string & path, int level_id, unsigned int seed,
+                 Uint32 keyframe_interval = REPLAY_KEYFRAME_INTERVAL,
+                 bool hashes = false);
+      bool isOpen (void) const;
+      void record (t_action action, bool paused, bool revived);
+      /* after every record () when hashes were asked for */
+      bool isHashing (void) const;
+      void recordHash (Uint64 hash);
+      /* true after record () when the level state is to be saved and
+       * passed to addKeyframe () */
+      bool keyframeDue (void) const;
+      void addKeyframe (const std::vector<Uint8> & state);
+      bool close (void);
+
+    private:
+      std::string path;
+      t_replay replay;
+      std::vector<Uint8> last_keyframe;
+      std::vector<Uint8> keyframe_delta;
+      bool recording;
+      bool hashing;
+  };
+
+  class Replay
+  {
+    public:
+      static bool load (const std::string & path, t_replay & replay);
+      static bool save (const std::string & path, const t_replay & replay);
+
+      /* the last keyframe at or before tick, -1 if there is none */
+      static int findKeyframe (const t_replay & replay, Uint32 tick);
+      static bool getKeyframe (const t_replay & replay, int keyframe,
+                               std::vector<Uint8> & state);
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_REPLAY_H_ */
@@ -6,7 +6,15 @@
  */
 
 #include "SdlManager.h"
+#include "AssetPack.h"
+#include "TextureCache.h"
+#include "../utils/Tracer.h"
+#include "../utils/Counters.h"
+#include "../utils/AllocTracker.h"
+#include "../level/LevelBatch.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 
 using namespace std;
@@ -14,17 +22,51 @@ using namespace std;
 namespace jumpinjack
 {
 
-  SdlManager::SdlManager ()
+  SdlManager::SdlManager () :
+      events_queue (ArenaAllocator<queued_event> (&frame_arena)),
+      events_head (0)
   {
     init ();
     mapped_events.reserve (MAX_EVENTS);
+    carried_events.reserve (MAX_EVENTS);
     players.reserve(MAX_PLAYERS);
     level        = 0;
     ingame_menu  = 0;
+    thread_pool  = new ThreadPool ();
+    sound_manager = new SoundManager ();
+    next_level   = 0;
+    next_level_id = 0;
+    next_level_compiled = false;
+    next_level_state = PRELOAD_NONE;
+    last_action  = ACTION_NONE;
+    memory_dump  = false;
+    memory_frames = 0;
+    record_hashes = false;
+    turbo_ticks  = 0;
+    turbo_frames = 0;
+    turbo_start  = 0;
+    turbo_report_start = 0;
+    turbo_report_ticks = 0;
   }
 
   SdlManager::~SdlManager ()
   {
+    if (memory_dump)
+      reportMemory ("exit");
+    if (replay_recorder.isOpen ())
+      replay_recorder.close ();
+    if (pacer.getFrameCount ())
+      printf ("Frame time: p50 %.2f ms, p99 %.2f ms, %lu late of %lu\n",
+              pacer.getFrameTime (0.5), pacer.getFrameTime (0.99),
+              pacer.getLateFrames (), pacer.getFrameCount ());
+    if (turbo_ticks)
+      {
+        double seconds = (double) (SDL_GetPerformanceCounter ()
+            - turbo_start) / SDL_GetPerformanceFrequency ();
+        printf ("Turbo: %lu ticks in %.1f s, %.0f ticks/s, %lu rendered\n",
+                turbo_ticks, seconds,
+                seconds > 0 ? turbo_ticks / seconds : 0.0, turbo_frames);
+      }
 
     SDL_DestroyRenderer (renderer);
     SDL_DestroyWindow (window);
@@ -32,9 +74,20 @@ namespace jumpinjack
     for (Player * player : players)
       delete player;
 
+    /* a pending parse writes into next_level_data */
+    thread_pool->wait ();
+    if (next_level)
+      delete next_level;
     if (level)
       delete level;
 
+    delete sound_manager;
+    delete thread_pool;
+
+    /* streamed music and fonts read straight from the mapping */
+    AssetPack::close ();
+    Counters::closeSegment ();
+
     SDL_Quit ();
   }
 
@@ -43,6 +96,23 @@ namespace jumpinjack
     //Initialization flag
     bool success = true;
 
+    //Counters for external readers (jjstat)
+    if (!Counters::openSegment (STATS_SEGMENT_NAME))
+      printf ("Unable to publish counters at %s\n", STATS_SEGMENT_NAME);
+
+    //Resources come from the pack when it exists, loose files otherwise
+    if (!AssetPack::open (
+        GlobalDefs::getResourceRoot () + "/" ASSET_PACK_FILENAME))
+      printf ("No asset pack, loading loose files from %s\n",
+              GlobalDefs::getResourceRoot ().c_str ());
+
+    //Headless runs need no display or sound card
+    if (GlobalDefs::headless)
+      {
+        SDL_setenv ("SDL_VIDEODRIVER", "dummy", 1);
+        SDL_setenv ("SDL_AUDIODRIVER", "dummy", 1);
+      }
+
     //Initialize SDL
     if (SDL_Init ( SDL_INIT_EVERYTHING) < 0)
       {
@@ -62,7 +132,9 @@ namespace jumpinjack
         SDL_WINDOWPOS_UNDEFINED,
                                    GlobalDefs::window_size.x,
                                    GlobalDefs::window_size.y,
-                                   SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL);
+                                   GlobalDefs::headless ?
+                                       SDL_WINDOW_HIDDEN :
+                                       SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL);
         if (window == NULL)
           {
             printf ("Window could not be created! SDL Error: %s\n",
@@ -72,14 +144,18 @@ namespace jumpinjack
         else
           {
             //Set window icon
-            SDL_Surface * window_icon = IMG_Load("data/img/icon.png");
+            SDL_Surface * window_icon = IMG_Load_RW(AssetPack::openRW(GlobalDefs::getResource(RESOURCE_IMAGE, "icon.png")),1);
             SDL_SetWindowIcon(window, window_icon);
             SDL_FreeSurface(window_icon);
 
             //Create vsynced renderer for window
             renderer = SDL_CreateRenderer (
                 window, -1,
-                SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+                GlobalDefs::headless ?
+                    SDL_RENDERER_SOFTWARE :
+                GlobalDefs::turbo ?
+                    SDL_RENDERER_ACCELERATED :
+                    SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
             if (renderer == NULL)
               {
                 printf ("Renderer could not be created! SDL Error: %s\n",
@@ -91,6 +167,22 @@ namespace jumpinjack
                 //Initialize renderer color
                 SDL_SetRenderDrawColor (renderer, 0xFF, 0xFF, 0xFF, 0xFF);
 
+                //Baked images are created in the renderer's own format
+                TextureCache::open (renderer);
+
+                //Pace presents against the display when they are vsynced
+                SDL_RendererInfo renderer_info;
+                SDL_DisplayMode display_mode;
+                pacer.setFramerate (GlobalDefs::turbo ?
+                    FRAMERATE_DYNAMIC : GlobalDefs::framerate);
+                if (GlobalDefs::framerate > 0)
+                  recorder.setBudget (1000.0 / GlobalDefs::framerate);
+                pacer.setLatePresent (GlobalDefs::late_present);
+                if (SDL_GetRendererInfo (renderer, &renderer_info) == 0
+                    && (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC)
+                    && SDL_GetWindowDisplayMode (window, &display_mode) == 0)
+                  pacer.setVsync (display_mode.refresh_rate);
+
                 //Initialize PNG loading
                 int imgFlags = IMG_INIT_PNG;
                 if (!(IMG_Init (imgFlags) & imgFlags))
@@ -126,14 +218,147 @@ namespace jumpinjack
 
   int SdlManager::startLevel(int level_id)
   {
+    TRACE_ZONE ("SdlManager::startLevel");
     assert (players.size() > 0);
     assert (!level);
 
-    level = new LevelManager(renderer, level_id, players);
+    srand (GlobalDefs::random_seed);
+    if (!record_path.empty ())
+      replay_recorder.open (record_path, level_id, GlobalDefs::random_seed,
+                            REPLAY_KEYFRAME_INTERVAL, record_hashes);
+
+    level = new LevelManager(renderer, level_id, players, sound_manager,
+                             thread_pool);
+    while (!level->loadStep ())
+      renderLoadingScreen (level->getLoadProgress ());
+    level->start ();
+    level->setProfiler (&profiler);
+    level->setFrameArena (&frame_arena);
+    reportMemory ("level " + to_string (level_id));
     ingame_menu  = new InGameMenu(renderer);
     return 0;
   }
 
+  bool SdlManager::preloadLevel(int level_id)
+  {
+    assert (level);
+    if (next_level_state != PRELOAD_NONE
+        || !LevelManager::levelExists (level_id))
+      return false;
+
+    next_level_id = level_id;
+    next_level_compiled = LevelManager::isCompiled (level_id);
+    if (next_level_compiled)
+      {
+        next_level_state = PRELOAD_PARSED;
+        return true;
+      }
+    next_level_state = PRELOAD_PARSING;
+    int player_count = players.size ();
+    thread_pool->submit ([this, level_id, player_count] ()
+      {
+        next_level_data = t_level_data ();
+        bool level_ok = LevelManager::parseLevel (level_id, player_count,
+                                                  next_level_data);
+        next_level_state = level_ok ? PRELOAD_PARSED : PRELOAD_FAILED;
+      });
+    return true;
+  }
+
+  void SdlManager::pollPreload ()
+  {
+    switch (next_level_state)
+    {
+      case PRELOAD_PARSED:
+        /* only what is not resident yet gets decoded */
+        next_level = new LevelManager (renderer, next_level_id, players,
+                                       sound_manager, thread_pool,
+                                       next_level_compiled ?
+                                           0 : &next_level_data);
+        next_level_state = PRELOAD_LOADING;
+        break;
+      case PRELOAD_LOADING:
+        /* a couple of texture uploads per frame */
+        if (next_level->loadStep (PRELOAD_UPLOADS_PER_FRAME))
+          next_level_state = PRELOAD_READY;
+        break;
+      case PRELOAD_FAILED:
+        cerr << "Unable to preload level " << next_level_id << endl;
+        next_level_state = PRELOAD_NONE;
+        break;
+      default:
+        break;
+    }
+  }
+
+  bool SdlManager::isLevelPreloaded()
+  {
+    pollPreload ();
+    return next_level_state == PRELOAD_READY;
+  }
+
+  bool SdlManager::isLevelFinished()
+  {
+    return level->is_finished ();
+  }
+
+  bool SdlManager::switchLevel()
+  {
+    TRACE_ZONE ("SdlManager::switchLevel");
+    if (!isLevelPreloaded ())
+      return false;
+
+    /* replays start from the recording's level_id, so a recording only
+     * covers one level */
+    if (replay_recorder.isOpen ())
+      {
+        replay_recorder.close ();
+        printf ("Recording stopped at the switch to level %d\n",
+                next_level_id);
+      }
+
+    set<string> old_images, new_images;
+    level->getImageAssets (old_images);
+    next_level->getImageAssets (new_images);
+
+    /* everything is resident already: build the items and swap */
+    delete level;
+    level = next_level;
+    next_level = 0;
+    next_level_state = PRELOAD_NONE;
+    level->start ();
+    level->setProfiler (&profiler);
+    level->setFrameArena (&frame_arena);
+
+    for (const string & image : old_images)
+      if (!new_images.count (image))
+        Drawable::releaseCached (image);
+    reportMemory ("level " + to_string (next_level_id));
+
+    return true;
+  }
+
+  void SdlManager::renderLoadingScreen (int progress)
+  {
+    /* keep the window responsive while assets are being decoded */
+    SDL_Event e;
+    while (SDL_PollEvent (&e))
+      ;
+
+    t_rect frame =
+      { GlobalDefs::window_size.x / 4, GlobalDefs::window_size.y / 2 - 10,
+        GlobalDefs::window_size.x / 2, 20 };
+    t_rect bar =
+      { frame.x + 2, frame.y + 2, (frame.w - 4) * progress / 100, frame.h - 4 };
+
+    SDL_SetRenderDrawColor (renderer, 0x00, 0x00, 0x00, 0xFF);
+    SDL_RenderClear (renderer);
+    SDL_SetRenderDrawColor (renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+    SDL_RenderDrawRect (renderer, &frame);
+    SDL_RenderFillRect (renderer, &bar);
+    SDL_RenderPresent (renderer);
+  }
+
   void SdlManager::mapEvent (
       t_event_type type, int event_id, t_event user_event, t_trigger trigger)
   {
@@ -143,11 +368,13 @@ namespace jumpinjack
 
   void SdlManager::pollEvents ()
   {
+    ProfilePhase profile (&profiler, PHASE_EVENTS);
+
     if (!level->is_alive())
       return;
 
-    while (!events_queue.empty ())
-      events_queue.pop ();
+    events_queue.clear ();
+    events_head = 0;
 
     const Uint8 *key_states = SDL_GetKeyboardState ( NULL);
 //    int x, y;
@@ -164,7 +391,7 @@ namespace jumpinjack
                   if (event.trigger == TRIGGER_HOLD
                       || (event.trigger == TRIGGER_DOWN && !event.status))
                     {
-                      events_queue.push (
+                      events_queue.push_back (
                         { event.user_event,
                           { 0, 0 } });
                     }
@@ -174,7 +401,7 @@ namespace jumpinjack
                 {
                   if (event.trigger == TRIGGER_UP && event.status)
                     {
-                      events_queue.push (
+                      events_queue.push_back (
                         { event.user_event,
                           { 0, 0 } });
                     }
@@ -197,7 +424,7 @@ namespace jumpinjack
       {
         if (e.type == SDL_QUIT)
           {
-            events_queue.push (
+            events_queue.push_back (
               { EVENT_EXIT,
                 { 0, 0 } });
           }
@@ -207,11 +434,10 @@ namespace jumpinjack
   t_event SdlManager::pollSingleEvent (
       t_point * point)
   {
-    if (events_queue.empty ())
+    if (events_head == events_queue.size ())
       return EVENT_NONE;
 
-    queued_event event = events_queue.front ();
-    events_queue.pop ();
+    queued_event event = events_queue[events_head++];
 
     if (point)
       {
@@ -224,6 +450,8 @@ namespace jumpinjack
   void SdlManager::applyAction (
       t_action action)
   {
+    ProfilePhase profile (&profiler, PHASE_ACTION);
+    last_action = action;
     level->applyAction(0, action);
   }
 
@@ -349,37 +577,388 @@ namespace jumpinjack
 
   void SdlManager::startLoop ()
   {
-    start_ticks = SDL_GetTicks ();
+    /* a running level should not touch the heap once warmed up */
+    ALLOC_STEADY (level && !level->is_paused ()
+                  && next_level_state == PRELOAD_NONE);
+
+    carried_events.assign (events_queue.begin () + events_head,
+                           events_queue.end ());
+    FrameArena::release (events_queue);
+    events_head = 0;
+    frame_arena.reset ();
+    events_queue.reserve (MAX_EVENTS);
+    events_queue.assign (carried_events.begin (), carried_events.end ());
+    profiler.beginFrame ();
+    profiler.begin (PHASE_WAIT);
+    pacer.beginFrame ();
+    profiler.end (PHASE_WAIT);
   }
 
   void SdlManager::endLoop ()
   {
-    if (GlobalDefs::framerate != FRAMERATE_DYNAMIC)
+    /* the frame rendered by render () goes out on the pacer's schedule */
+    profiler.begin (PHASE_WAIT);
+    pacer.waitForPresent ();
+    profiler.end (PHASE_WAIT);
+
+    if (renderDue ())
       {
-        Uint32 used_ticks = SDL_GetTicks () - start_ticks;
-        if (used_ticks < 1000 / (Uint32) GlobalDefs::framerate)
-          SDL_Delay (1000 / (Uint32) GlobalDefs::framerate - used_ticks);
-        else
-          cerr << "WARNING! Running under framerate. "
-              << used_ticks - 1000 / (Uint32) GlobalDefs::framerate << endl;
+        profiler.begin (PHASE_PRESENT);
+        SDL_RenderPresent (renderer);
+        profiler.end (PHASE_PRESENT);
+      }
+    turboTick ();
+
+    pacer.framePresented ();
+    profiler.endFrame ();
+    Counters::set (COUNTER_ARENA_BYTES, frame_arena.getUsed ());
+    Counters::endFrame ();
+    ALLOC_FRAME_END ();
+
+    t_level_stats stats = t_level_stats ();
+    if (level && !level->is_paused ())
+      stats = level->getFrameStats ();
+    recorder.record (*profiler.getFrame (0), last_action, stats);
+    last_action = ACTION_NONE;
+  }
+
+  FrameProfiler * SdlManager::getProfiler ()
+  {
+    return &profiler;
+  }
+
+  const FramePacer * SdlManager::getPacer ()
+  {
+    return &pacer;
+  }
+
+  FlightRecorder * SdlManager::getFlightRecorder ()
+  {
+    return &recorder;
+  }
+
+  MemoryReport * SdlManager::getMemoryReport ()
+  {
+    return &memory;
+  }
+
+  void SdlManager::setMemoryDump (bool dump)
+  {
+    memory_dump = dump;
+  }
+
+  void SdlManager::recordTo (const string & path, bool hashes)
+  {
+    record_path = path;
+    record_hashes = hashes;
+  }
+
+  void SdlManager::replayTick (const t_replay & replay, Uint32 tick)
+  {
+    profiler.beginFrame ();
+    frame_arena.reset ();
+
+    Uint8 input = replay.ticks[tick];
+    applyAction ((t_action) (input & TICK_ACTION_MASK));
+    /* applied by the tick's update (), after the clock, as in live play */
+    if (binary_search (replay.revives.begin (), replay.revives.end (), tick))
+      level->requestRevive ();
+    if (!(input & TICK_PAUSED))
+      level->update ();
+    /* replays only show up in turbo mode, fast forwarded */
+    if (GlobalDefs::turbo && renderDue ())
+      {
+        SDL_PumpEvents ();
+        render ();
+        SDL_RenderPresent (renderer);
+      }
+    turboTick ();
+
+    profiler.endFrame ();
+    Counters::set (COUNTER_ARENA_BYTES, frame_arena.getUsed ());
+    Counters::endFrame ();
+    ALLOC_FRAME_END ();
+  }
+
+  bool SdlManager::startReplay (const string & path, t_replay & replay)
+  {
+    if (!Replay::load (path, replay))
+      {
+        printf ("Unable to read replay %s\n", path.c_str ());
+        return false;
+      }
+
+    GlobalDefs::random_seed = replay.seed;
+    /* gameplay timers are converted with it */
+    if (replay.framerate > 0)
+      GlobalDefs::framerate = replay.framerate;
+    startLevel (replay.level_id);
+    level->setScripted (true);
+    return true;
+  }
+
+  bool SdlManager::runReplay (const string & path, Uint32 from_tick)
+  {
+    t_replay replay;
+    if (!startReplay (path, replay))
+      return false;
+
+    Uint32 tick = 0;
+    if (from_tick > 0)
+      {
+        Uint64 seek_start = SDL_GetPerformanceCounter ();
+        from_tick = min (from_tick, (Uint32) replay.ticks.size ());
+        int keyframe = Replay::findKeyframe (replay, from_tick);
+        if (keyframe >= 0)
+          {
+            if (!Replay::getKeyframe (replay, keyframe, keyframe_state)
+                || !level->restoreState (keyframe_state))
+              {
+                printf ("Corrupt keyframe %d in %s\n", keyframe,
+                        path.c_str ());
+                return false;
+              }
+            tick = replay.keyframes[keyframe].tick;
+          }
+        Uint32 keyframe_tick = tick;
+        for (; tick < from_tick; ++tick)
+          replayTick (replay, tick);
+        printf ("Seeked to tick %u: keyframe at tick %u, %u ticks "
+                "simulated in %.3f ms\n", from_tick, keyframe_tick,
+                from_tick - keyframe_tick,
+                (double) (SDL_GetPerformanceCounter () - seek_start) * 1000.0
+                    / SDL_GetPerformanceFrequency ());
       }
+
+    Uint32 played = replay.ticks.size () - tick;
+    Uint64 start = SDL_GetPerformanceCounter ();
+    for (; tick < replay.ticks.size (); ++tick)
+      replayTick (replay, tick);
+    double seconds = (double) (SDL_GetPerformanceCounter () - start)
+        / SDL_GetPerformanceFrequency ();
+
+    printf ("Replayed %lu ticks (%.1f s of play) in %.3f s, %.0f ticks/s\n",
+            (unsigned long) played,
+            replay.framerate > 0 ? (double) played / replay.framerate : 0.0,
+            seconds, seconds > 0 ? played / seconds : 0.0);
+    printf ("Final state: tick %u, %d items, player %s\n",
+            level->getClock ().now (), level->getFrameStats ().items,
+            level->is_alive () ? "alive" : "dead");
+    return true;
+  }
+
+  static const struct
+  {
+      const char * name;
+      size_t offset;
+  } entity_fields[] =
+    {
+      { "type", offsetof (t_entity_state, type) },
+      { "x", offsetof (t_entity_state, x) },
+      { "y", offsetof (t_entity_state, y) },
+      { "dx", offsetof (t_entity_state, dx) },
+      { "dy", offsetof (t_entity_state, dy) },
+      { "sub_x", offsetof (t_entity_state, sub_x) },
+      { "sub_y", offsetof (t_entity_state, sub_y) },
+      { "sub_dx", offsetof (t_entity_state, sub_dx) },
+      { "sub_dy", offsetof (t_entity_state, sub_dy) },
+      { "alive", offsetof (t_entity_state, alive) },
+      { "status", offsetof (t_entity_state, status) },
+      { "age", offsetof (t_entity_state, age) },
+      { "direction", offsetof (t_entity_state, direction) },
+      { "onJump", offsetof (t_entity_state, on_jump) },
+      { "jumpId", offsetof (t_entity_state, jump_id) },
+      { "hit_counter", offsetof (t_entity_state, hit_counter) },
+      { "status_count", offsetof (t_entity_state, status_count) } };
+
+  static const char * item_type_names[] =
+    { "passive", "projectile", "player", "enemy", "checkpoint" };
+
+  static Sint32 entity_field (const t_entity_state & state, size_t offset)
+  {
+    return *(const Sint32 *) ((const Uint8 *) &state + offset);
+  }
+
+  /* items are matched by position in the level's list, so a missing or
+   * extra spawn shows as a run of differing items after it */
+  static void print_entity_diff (const vector<t_entity_state> & replayed,
+                                 const vector<t_entity_state> & recorded)
+  {
+    if (replayed.size () != recorded.size ())
+      printf ("  %lu items, %lu recorded\n", (unsigned long) replayed.size (),
+              (unsigned long) recorded.size ());
+    size_t n_items = max (replayed.size (), recorded.size ());
+    for (size_t i = 0; i < n_items; i++)
+      {
+        if (i >= replayed.size () || i >= recorded.size ())
+          {
+            const t_entity_state & extra =
+                i < replayed.size () ? replayed[i] : recorded[i];
+            printf ("  item %lu (%s) only %s\n", (unsigned long) i,
+                    item_type_names[extra.type],
+                    i < replayed.size () ? "replayed" : "recorded");
+            continue;
+          }
+        for (const auto & field : entity_fields)
+          {
+            Sint32 now = entity_field (replayed[i], field.offset);
+            Sint32 then = entity_field (recorded[i], field.offset);
+            if (now != then)
+              printf ("  item %lu (%s) %s: %d, recorded %d\n",
+                      (unsigned long) i, item_type_names[recorded[i].type],
+                      field.name, now, then);
+          }
+      }
+  }
+
+  bool SdlManager::verifyReplay (const string & path)
+  {
+    t_replay replay;
+    if (!startReplay (path, replay))
+      return false;
+    if (replay.hashes.empty ())
+      {
+        printf ("%s was recorded without state hashes\n", path.c_str ());
+        return false;
+      }
+
+    Uint32 tick = 0;
+    for (; tick < replay.ticks.size (); ++tick)
+      {
+        replayTick (replay, tick);
+        if (level->getStateHash () != replay.hashes[tick])
+          break;
+      }
+    if (tick == replay.ticks.size ())
+      {
+        printf ("Verified %lu ticks, no divergence\n",
+                (unsigned long) replay.ticks.size ());
+        return true;
+      }
+    Uint32 diverged = tick;
+    printf ("Diverged at tick %u (clock %u)\n", diverged,
+            level->getClock ().now ());
+
+    /* the recorded state is only known at keyframes: play on to the
+     * next one and compare the items there */
+    int keyframe = Replay::findKeyframe (replay, tick + 1);
+    if (keyframe < 0 || replay.keyframes[keyframe].tick != tick + 1)
+      keyframe++;
+    if (keyframe >= (int) replay.keyframes.size ())
+      {
+        printf ("No keyframe after tick %u to compare items with\n", tick);
+        return false;
+      }
+    Uint32 keyframe_tick = replay.keyframes[keyframe].tick;
+    for (++tick; tick < keyframe_tick; ++tick)
+      replayTick (replay, tick);
+
+    vector<t_entity_state> replayed, recorded;
+    level->getEntityStates (replayed);
+    if (!Replay::getKeyframe (replay, keyframe, keyframe_state)
+        || !level->restoreState (keyframe_state))
+      {
+        printf ("Corrupt keyframe %d in %s\n", keyframe, path.c_str ());
+        return false;
+      }
+    level->getEntityStates (recorded);
+    printf ("Items at the keyframe of tick %u, %u ticks later:\n",
+            keyframe_tick, keyframe_tick - diverged - 1);
+    print_entity_diff (replayed, recorded);
+    return false;
+  }
+
+  bool SdlManager::runBatch (const string & path, int n_instances)
+  {
+    t_replay replay;
+    if (!Replay::load (path, replay))
+      {
+        printf ("Unable to read replay %s\n", path.c_str ());
+        return false;
+      }
+    assert (players.size () > 0 && n_instances > 0);
+    GlobalDefs::random_seed = replay.seed;
+    if (replay.framerate > 0)
+      GlobalDefs::framerate = replay.framerate;
+    srand (GlobalDefs::random_seed);
+
+    Player * player = players[0];
+    LevelBatch batch (renderer, sound_manager, thread_pool, replay.level_id,
+                      n_instances, player->getFilePath (),
+                      player->getSpriteLength (),
+                      player->getSpriteStartLine (),
+                      player->getSpriteFrequency ());
+
+    /* every instance gets the same input, so they must all end alike */
+    vector<t_action> actions (n_instances);
+    vector<Uint8> flags (n_instances);
+    for (Uint32 tick = 0; tick < replay.ticks.size (); ++tick)
+      {
+        Uint8 input = replay.ticks[tick];
+        Uint8 flag = input & TICK_PAUSED ? BATCH_PAUSED : 0;
+        if (binary_search (replay.revives.begin (), replay.revives.end (),
+                           tick))
+          flag |= BATCH_REVIVE;
+        fill (actions.begin (), actions.end (),
+              (t_action) (input & TICK_ACTION_MASK));
+        fill (flags.begin (), flags.end (), flag);
+        batch.step (actions.data (), flags.data ());
+      }
+
+    printf ("%d instances, %lu ticks: %.0f ticks/s on %d threads, "
+            "%s boxes\n", n_instances, batch.getTicks (),
+            batch.getTicksPerSecond (), thread_pool->getThreadCount (),
+            AabbSet::getKernelName ());
+
+    Uint64 hash = batch.getInstance (0)->getStateHash ();
+    bool same = !replay.hashes.empty () ? hash == replay.hashes.back () :
+        true;
+    if (!same)
+      printf ("Instance 0 ended differently than the recording\n");
+    for (int i = 1; i < n_instances; i++)
+      if (batch.getInstance (i)->getStateHash () != hash)
+        {
+          printf ("Instance %d ended differently than instance 0\n", i);
+          same = false;
+        }
+    return same;
+  }
+
+  void SdlManager::collectMemory ()
+  {
+    memory.clear ();
+    Drawable::getCacheMemory (memory);
+    sound_manager->getMemory (memory);
+    if (level)
+      level->getMemory (memory);
+  }
+
+  void SdlManager::reportMemory (const string & when)
+  {
+    TextureCache::reportMemory ();
+    if (!memory_dump)
+      return;
+    collectMemory ();
+    memory.print (stdout, when);
   }
 
   void SdlManager::update (bool game_paused)
   {
+    TRACE_ZONE ("SdlManager::update");
     if (game_paused)
       {
+        replay_recorder.record ((t_action) last_action, true, false);
         level->pause(true);
         switch(ingame_menu->poll())
         {
           case MENU_CONTINUE:
             level->pause(false);
-            events_queue.push (
+            events_queue.push_back (
               { EVENT_MENU_UNLOAD,
                 { 0, 0 } });
             break;
           case MENU_EXIT:
-            events_queue.push (
+            events_queue.push_back (
               { EVENT_EXIT,
                 { 0, 0 } });
             break;
@@ -392,13 +971,60 @@ namespace jumpinjack
       }
     else
       {
+        bool was_alive = level->is_alive ();
         level->update ();
+        replay_recorder.record ((t_action) last_action, false,
+                                !was_alive && level->is_alive ());
+      }
+    if (replay_recorder.isHashing ())
+      replay_recorder.recordHash (level->getStateHash ());
+    if (replay_recorder.keyframeDue ())
+      {
+        level->saveState (keyframe_state);
+        replay_recorder.addKeyframe (keyframe_state);
+      }
+
+    if (next_level_state != PRELOAD_NONE)
+      pollPreload ();
+  }
+
+  bool SdlManager::renderDue (void) const
+  {
+    if (!GlobalDefs::turbo)
+      return true;
+    if (GlobalDefs::turbo == TURBO_NO_RENDER)
+      return false;
+    return turbo_ticks % GlobalDefs::turbo == 0;
+  }
+
+  void SdlManager::turboTick (void)
+  {
+    if (!GlobalDefs::turbo)
+      return;
+    Uint64 now = SDL_GetPerformanceCounter ();
+    if (!turbo_ticks)
+      turbo_start = turbo_report_start = now;
+    if (renderDue ())
+      turbo_frames++;
+    turbo_ticks++;
+
+    Uint64 elapsed = now - turbo_report_start;
+    if (elapsed >= SDL_GetPerformanceFrequency () * TURBO_REPORT_SECONDS)
+      {
+        printf ("Turbo: %.0f ticks/s\n",
+                (turbo_ticks - turbo_report_ticks)
+                    * (double) SDL_GetPerformanceFrequency () / elapsed);
+        turbo_report_start = now;
+        turbo_report_ticks = turbo_ticks;
       }
   }
 
   void SdlManager::render ()
   {
+    TRACE_ZONE ("SdlManager::render");
     assert(level);
+    if (!renderDue ())
+      return;
 
     /* Clear screen */
     SDL_SetRenderDrawColor (renderer, 0xFF, 0xFF, 0xFF, 0xFF);
@@ -406,6 +1032,7 @@ namespace jumpinjack
 
     level->render ();
 
+    ProfilePhase profile (&profiler, PHASE_RENDER_OVERLAY);
     if (level->is_paused())
       {
         assert(ingame_menu);
@@ -413,7 +1040,17 @@ namespace jumpinjack
           { 0, 0 });
       }
 
-    /* Update screen */
-    SDL_RenderPresent (renderer);
+    double budget_ms = GlobalDefs::framerate > 0 ?
+        1000.0 / GlobalDefs::framerate : 0;
+    profiler.renderHud (renderer, budget_ms);
+
+    if (memory.isOverlayVisible ())
+      {
+        if (memory_frames++ % MEMORY_OVERLAY_REFRESH == 0)
+          collectMemory ();
+        memory.renderOverlay (renderer);
+      }
+    else
+      memory_frames = 0;
   }
 } /* namespace sdlfw */
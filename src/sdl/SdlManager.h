@@ -12,13 +12,20 @@
 #include "../characters/Player.h"
 #include "../level/LevelManager.h"
 #include "../level/InGameMenu.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/FrameArena.h"
+#include "FramePacer.h"
+#include "FrameProfiler.h"
+#include "FlightRecorder.h"
+#include "MemoryReport.h"
+#include "Replay.h"
 
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
 #include <vector>
-#include <queue>
 #include <string>
+#include <atomic>
 
 struct queued_event
 {
@@ -26,6 +33,19 @@ struct queued_event
     t_point point;
 };
 
+#define PRELOAD_UPLOADS_PER_FRAME 2
+/* ticks per second are printed this often in turbo mode */
+#define TURBO_REPORT_SECONDS 5
+
+enum preload_state {
+  PRELOAD_NONE,
+  PRELOAD_PARSING,
+  PRELOAD_PARSED,
+  PRELOAD_FAILED,
+  PRELOAD_LOADING,
+  PRELOAD_READY
+};
+
 enum menu_option {
   MENU_OPTION_CONTINUE,
   MENU_OPTION_EXIT
@@ -44,6 +64,15 @@ namespace jumpinjack
 
       int startLevel(int level_id);
 
+      /* level streaming: the next level is parsed and decoded while the
+       * current one is played, switchLevel () swaps them once it is ready.
+       * preloadLevel () is false when there is no such level, a recording
+       * in progress stops at the switch */
+      bool preloadLevel(int level_id);
+      bool isLevelPreloaded();
+      bool isLevelFinished();
+      bool switchLevel();
+
       void mapEvent (
           t_event_type type, int event_id, t_event user_event,
           t_trigger trigger);
@@ -59,20 +88,84 @@ namespace jumpinjack
       void endLoop ();
       void update (bool paused = false);
       void render ();
+
+      FrameProfiler * getProfiler ();
+      /* frame time percentiles and late frames so far */
+      const FramePacer * getPacer ();
+      FlightRecorder * getFlightRecorder ();
+      MemoryReport * getMemoryReport ();
+      /* full memory breakdown on stdout at level load and exit */
+      void setMemoryDump (bool dump);
+
+      /* ticks of the level started next are recorded to path, with the
+       * level's state hash after each one if hashes is set */
+      void recordTo (const std::string & path, bool hashes = false);
+      /* plays a recording headless and as fast as possible, no events,
+       * pacing or rendering. From from_tick on: the nearest keyframe is
+       * restored and only the ticks after it simulated */
+      bool runReplay (const std::string & path, Uint32 from_tick = 0);
+      /* plays a recording made with hashes and reports the first tick
+       * whose state differs from the recorded one, false if any does */
+      bool verifyReplay (const std::string & path);
+      /* plays a recording in that many instances at once through a
+       * LevelBatch, reports the ticks per second of all of them and
+       * whether they all ended in the same state */
+      bool runBatch (const std::string & path, int instances);
     private:
       bool init();
+      void renderLoadingScreen (int progress);
+      void pollPreload ();
+      void collectMemory ();
+      void reportMemory (const std::string & when);
+      bool startReplay (const std::string & path, t_replay & replay);
+      void replayTick (const t_replay & replay, Uint32 tick);
+      /* false for the ticks turbo mode does not render */
+      bool renderDue (void) const;
+      void turboTick (void);
 
       SDL_Window * window;
       SDL_Renderer * renderer;
 
-      Uint32 start_ticks;
+      FramePacer pacer;
+      FrameProfiler profiler;
+      FlightRecorder recorder;
+      MemoryReport memory;
+      bool memory_dump;
+      unsigned long memory_frames;
+      std::string record_path;
+      bool record_hashes;
+      ReplayRecorder replay_recorder;
+      std::vector<Uint8> keyframe_state;
+      /* turbo mode */
+      unsigned long turbo_ticks;
+      unsigned long turbo_frames;
+      Uint64 turbo_start;
+      Uint64 turbo_report_start;
+      unsigned long turbo_report_ticks;
+      /* transient per frame data, reset by startLoop */
+      FrameArena frame_arena;
+      int last_action;
 
       std::vector<t_event_record> mapped_events;
-      std::queue<queued_event> events_queue;
+      /* consumed from events_head on. Events queued by update () for the
+       * next frame are carried over the arena reset */
+      ArenaVector<queued_event> events_queue;
+      size_t events_head;
+      std::vector<queued_event> carried_events;
 
       std::vector<Player *> players;
       LevelManager * level;
       InGameMenu * ingame_menu;
+      ThreadPool * thread_pool;
+      SoundManager * sound_manager;
+
+      /* preloading */
+      LevelManager * next_level;
+      int next_level_id;
+      /* read in place by the LevelManager, nothing is parsed ahead */
+      bool next_level_compiled;
+      t_level_data next_level_data;
+      std::atomic<int> next_level_state;
   };
 
 } /* namespace sdlfw */
@@ -1,4 +1,7 @@
 #include "SoundManager.h"
+#include "AssetPack.h"
+#include "../utils/Tracer.h"
+#include "../utils/Counters.h"
 
 using namespace std;
 
@@ -10,6 +13,7 @@ SoundManager::SoundManager ()
   /* first assigned will be number 1 */
   next_sound_id = 0;
   audio_ok = true;
+  muted = false;
 
   //Initialize SDL_mixer
   int frequency = 44100;
@@ -37,43 +41,87 @@ SoundManager::~SoundManager ()
 
 unsigned long SoundManager::loadFromFile (const string & path)
 {
+  TRACE_ZONE ("SoundManager::loadFromFile");
   if (!audio_ok)
     return 0;
 
-  ++next_sound_id;
-  Mix_Chunk * new_sound = Mix_LoadWAV( path.c_str() );
+  if (unsigned long sound_id = findLoaded (path))
+    return sound_id;
+
+  Mix_Chunk * new_sound = Mix_LoadWAV_RW (AssetPack::openRW (path), 1);
   if (new_sound == NULL)
   {
     cerr << "ERROR LOADING SOUND " << path << endl;
     return 0;
   }
 
-  cachedSounds[next_sound_id] = new_sound;
-
-  return next_sound_id;
+  return addSound(new_sound, path);
 }
 
 unsigned long SoundManager::loadMusic (const string & path)
 {
+  TRACE_ZONE ("SoundManager::loadMusic");
   if (!audio_ok)
     return 0;
 
-  ++next_sound_id;
-  Mix_Music * new_music = Mix_LoadMUS ( path.c_str() );
+  if (unsigned long sound_id = findLoaded (path))
+    return sound_id;
+
+  Mix_Music * new_music = Mix_LoadMUS_RW (AssetPack::openRW (path), 1);
   if (new_music == NULL)
   {
     cerr << "ERROR LOADING MUSIC " << path << endl;
     return 0;
   }
 
-  cachedMusic[next_sound_id] = new_music;
+  return addMusic(new_music, path);
+}
+
+unsigned long SoundManager::addSound (Mix_Chunk * sound, const string & path)
+{
+  if (!audio_ok || !sound)
+    return 0;
+
+  ++next_sound_id;
+  cachedSounds[next_sound_id] = sound;
+  loadedPaths[path] = next_sound_id;
+
+  return next_sound_id;
+}
+
+unsigned long SoundManager::addMusic (Mix_Music * music, const string & path)
+{
+  if (!audio_ok || !music)
+    return 0;
+
+  ++next_sound_id;
+  cachedMusic[next_sound_id] = music;
+  loadedPaths[path] = next_sound_id;
 
   return next_sound_id;
 }
 
+unsigned long SoundManager::findLoaded (const string & path) const
+{
+  map<string, unsigned long>::const_iterator it = loadedPaths.find (path);
+  return (it != loadedPaths.end ()) ? it->second : 0;
+}
+
+bool SoundManager::audioEnabled (void) const
+{
+  return audio_ok;
+}
+
+void SoundManager::setMuted (bool set)
+{
+  muted = set;
+}
+
 void SoundManager::playMusic(unsigned int sound_id, int loops)
 {
-  if( audio_ok && Mix_PlayMusic(cachedMusic[sound_id], loops) == -1 )
+  TRACE_ZONE ("SoundManager::playMusic");
+  Counters::add (COUNTER_SOUNDS);
+  if( audio_ok && !muted && Mix_PlayMusic(cachedMusic[sound_id], loops) == -1 )
   {
     printf("ERROR PLAYING MUSIC\n");
   }
@@ -95,12 +143,40 @@ void SoundManager::stopMusic()
 
 void SoundManager::playSound(unsigned int sound_id, int loops)
 {
-  if( audio_ok && Mix_PlayChannel( -1, cachedSounds[sound_id], loops ) == -1 )
+  TRACE_ZONE ("SoundManager::playSound");
+  Counters::add (COUNTER_SOUNDS);
+  if( audio_ok && !muted && Mix_PlayChannel( -1, cachedSounds[sound_id], loops ) == -1 )
   {
     printf("ERROR PLAYING SOUND\n");
   }
 }
 
+void SoundManager::getMemory (MemoryReport & report) const
+{
+  for (map<string, unsigned long>::const_iterator it = loadedPaths.begin ();
+       it != loadedPaths.end (); ++it)
+  {
+    map<unsigned long, Mix_Chunk *>::const_iterator chunk =
+        cachedSounds.find (it->second);
+    if (chunk != cachedSounds.end ())
+    {
+      report.add (MEMORY_SOUNDS, it->first, chunk->second->alen);
+      continue;
+    }
+    if (!cachedMusic.count (it->second))
+      continue;
+
+    /* music is decoded while it plays, what stays resident is the source */
+    SDL_RWops * source = AssetPack::openRW (it->first);
+    if (!source)
+      continue;
+    Sint64 size = SDL_RWsize (source);
+    SDL_RWclose (source);
+    if (size > 0)
+      report.add (MEMORY_MUSIC, it->first, (size_t) size);
+  }
+}
+
 void SoundManager::cleanCache (void)
 {
   for (map<unsigned long, Mix_Chunk *>::iterator it = cachedSounds.begin ();
@@ -116,6 +192,7 @@ void SoundManager::cleanCache (void)
     Mix_FreeMusic( it->second );
   }
   cachedMusic.clear();
+  loadedPaths.clear();
 }
 
 }
@@ -14,6 +14,7 @@
 #include <SDL2/SDL_mixer.h>
 
 #include "../GlobalDefs.h"
+#include "MemoryReport.h"
 
 namespace jumpinjack
 {
@@ -26,16 +27,26 @@ namespace jumpinjack
 
       unsigned long loadFromFile (const std::string & path);
       unsigned long loadMusic (const std::string & path);
+      unsigned long addSound (Mix_Chunk * sound, const std::string & path);
+      unsigned long addMusic (Mix_Music * music, const std::string & path);
+      unsigned long findLoaded (const std::string & path) const;
+      bool audioEnabled (void) const;
+      /* plays nothing while set, levels stepped on worker threads must not
+       * reach the mixer */
+      void setMuted (bool set);
       void playSound(unsigned int sound_id, int loops = 0);
       void playMusic(unsigned int sound_id, int loops = -1);
       void setMusicVolume(int volume);
       void stopMusic();
       void cleanCache (void);
+      void getMemory (MemoryReport & report) const;
     private:
       bool audio_ok;
+      bool muted;
       unsigned long next_sound_id;
       std::map<unsigned long, Mix_Chunk *> cachedSounds;
       std::map<unsigned long, Mix_Music *> cachedMusic;
+      std::map<std::string, unsigned long> loadedPaths;
   };
 
 } /* namespace jumpinjack */
@@ -0,0 +1,440 @@
+/*
+ * TextureCache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "TextureCache.h"
+#include "AssetPack.h"
+#include "../utils/Lz.h"
+#include "../utils/Tracer.h"
+
+#include <cstdio>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <SDL2/SDL_image.h>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  string TextureCache::cache_dir;
+  Uint32 TextureCache::format = SDL_PIXELFORMAT_ARGB8888;
+  bool TextureCache::premultiplied = false;
+  SDL_BlendMode TextureCache::blend_mode = SDL_BLENDMODE_BLEND;
+  map<string, Uint32> TextureCache::manifest;
+  set<Uint32> TextureCache::renderer_formats;
+  map<SDL_Texture *, t_texture_size> TextureCache::textures;
+  t_texture_size TextureCache::memory_usage = { 0, 0 };
+
+  static const struct
+  {
+      const char * name;
+      Uint32 format;
+  } manifest_formats[] =
+    {
+      { "rgb565", SDL_PIXELFORMAT_RGB565 },
+      { "argb1555", SDL_PIXELFORMAT_ARGB1555 },
+      { "rgba5551", SDL_PIXELFORMAT_RGBA5551 },
+      { "argb4444", SDL_PIXELFORMAT_ARGB4444 },
+      { "rgba4444", SDL_PIXELFORMAT_RGBA4444 },
+      { "argb8888", SDL_PIXELFORMAT_ARGB8888 } };
+
+  void TextureCache::open (SDL_Renderer * renderer)
+  {
+    /* first 32 bit format with alpha the renderer takes as is */
+    SDL_RendererInfo info;
+    format = SDL_PIXELFORMAT_ARGB8888;
+    renderer_formats.clear ();
+    if (SDL_GetRendererInfo (renderer, &info) == 0)
+    {
+      for (Uint32 i = info.num_texture_formats; i > 0; --i)
+      {
+        Uint32 candidate = info.texture_formats[i - 1];
+        renderer_formats.insert (candidate);
+        if (SDL_ISPIXELFORMAT_ALPHA(candidate)
+            && SDL_BYTESPERPIXEL(candidate) == 4)
+          format = candidate;
+      }
+    }
+
+    /* premultiplied blending is not available on every renderer */
+    SDL_BlendMode premultiplied_mode = SDL_ComposeCustomBlendMode (
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+        SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE,
+        SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    SDL_Texture * probe = SDL_CreateTexture (renderer, format,
+                                             SDL_TEXTUREACCESS_STATIC, 1, 1);
+    premultiplied = probe
+        && SDL_SetTextureBlendMode (probe, premultiplied_mode) == 0;
+    blend_mode = premultiplied ? premultiplied_mode : SDL_BLENDMODE_BLEND;
+    if (probe)
+      SDL_DestroyTexture (probe);
+
+    char * pref_path = SDL_GetPrefPath ("jumpinjack", "texcache");
+    if (pref_path)
+    {
+      cache_dir = pref_path;
+      SDL_free (pref_path);
+    }
+    else
+      printf ("No texture cache directory: %s\n", SDL_GetError ());
+
+    loadManifest ();
+  }
+
+  void TextureCache::loadManifest (void)
+  {
+    manifest.clear ();
+
+    string manifest_file = GlobalDefs::getResource (RESOURCE_DATA,
+                                                    TEXTURE_MANIFEST);
+    SDL_RWops * file = AssetPack::openRW (manifest_file);
+    if (!file)
+      return;
+    string contents;
+    char buffer[1024];
+    size_t read;
+    while ((read = SDL_RWread (file, buffer, 1, sizeof(buffer))) > 0)
+      contents.append (buffer, read);
+    SDL_RWclose (file);
+
+    istringstream in (contents);
+    string line;
+    while (getline (in, line))
+    {
+      istringstream fields (line);
+      string image, format_name;
+      if (!(fields >> image) || image[0] == '#')
+        continue;
+      fields >> format_name;
+
+      bool known = false;
+      for (const auto & entry : manifest_formats)
+      {
+        if (format_name == entry.name)
+        {
+          manifest[image] = entry.format;
+          known = true;
+        }
+      }
+      if (!known)
+        printf ("%s: unknown texture format '%s' for %s\n",
+                manifest_file.c_str (), format_name.c_str (), image.c_str ());
+    }
+  }
+
+  Uint32 TextureCache::getFormat (const string & path)
+  {
+    size_t slash = path.rfind ('/');
+    string image = slash == string::npos ? path : path.substr (slash + 1);
+    map<string, Uint32>::const_iterator it = manifest.find (image);
+    if (it == manifest.end ())
+    {
+      size_t dot = image.rfind ('.');
+      if (dot != string::npos)
+        it = manifest.find ("*" + image.substr (dot));
+    }
+    if (it == manifest.end () || it->second == SDL_PIXELFORMAT_ARGB8888)
+      return format;
+    return it->second;
+  }
+
+  Uint64 TextureCache::hash (const Uint8 * data, size_t size)
+  {
+    /* FNV-1a */
+    Uint64 value = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+      value ^= data[i];
+      value *= 1099511628211ULL;
+    }
+    return value;
+  }
+
+  SDL_Surface * TextureCache::loadImage (const string & path)
+  {
+    const Uint8 * source;
+    size_t source_size;
+    vector<Uint8> file_data;
+    if (!AssetPack::find (path, &source, &source_size))
+    {
+      SDL_RWops * file = SDL_RWFromFile (path.c_str (), "rb");
+      Sint64 file_size = file ? SDL_RWsize (file) : -1;
+      if (file_size > 0)
+      {
+        file_data.resize (file_size);
+        if (SDL_RWread (file, file_data.data (), file_size, 1) != 1)
+          file_data.clear ();
+      }
+      if (file)
+        SDL_RWclose (file);
+      if (file_data.empty ())
+      {
+        printf ("Unable to load image %s! SDL Error: %s\n", path.c_str (),
+                SDL_GetError ());
+        return NULL;
+      }
+      source = file_data.data ();
+      source_size = file_data.size ();
+    }
+
+    Uint64 source_hash = hash (source, source_size);
+    Uint32 target_format = getFormat (path);
+    string cache_file = getCacheFile (path);
+    if (!cache_file.empty ())
+    {
+      SDL_Surface * cached = readCache (cache_file, source_hash,
+                                        target_format);
+      if (cached)
+        return cached;
+    }
+
+    SDL_Surface * decoded = IMG_Load_RW (
+        SDL_RWFromConstMem (source, source_size), 1);
+    if (decoded == NULL)
+    {
+      printf ("Unable to load image %s! SDL_image Error: %s\n", path.c_str (),
+              IMG_GetError ());
+      return NULL;
+    }
+
+    SDL_Surface * baked = bake (decoded, target_format);
+    SDL_FreeSurface (decoded);
+    if (baked && !cache_file.empty ())
+      writeCache (cache_file, source_hash, baked);
+    return baked;
+  }
+
+  SDL_Surface * TextureCache::bake (SDL_Surface * decoded,
+                                    Uint32 target_format)
+  {
+    TRACE_ZONE ("TextureCache::bake");
+    SDL_Surface * argb = SDL_ConvertSurfaceFormat (decoded,
+                                                   SDL_PIXELFORMAT_ARGB8888, 0);
+    if (argb == NULL)
+    {
+      printf ("Unable to convert image! SDL Error: %s\n", SDL_GetError ());
+      return NULL;
+    }
+
+    /* the magenta colour key becomes transparent black, which also keeps
+     * it from bleeding into its neighbours under linear filtering */
+    for (int y = 0; y < argb->h; ++y)
+    {
+      Uint32 * row = (Uint32 *) ((Uint8 *) argb->pixels + y * argb->pitch);
+      for (int x = 0; x < argb->w; ++x)
+      {
+        Uint32 pixel = row[x];
+        Uint32 alpha = pixel >> 24;
+        if (pixel == 0xFFFF00FF || alpha == 0)
+          row[x] = 0;
+        else if (premultiplied && alpha != 0xFF)
+        {
+          Uint32 r = ((pixel >> 16) & 0xFF) * alpha / 0xFF;
+          Uint32 g = ((pixel >> 8) & 0xFF) * alpha / 0xFF;
+          Uint32 b = (pixel & 0xFF) * alpha / 0xFF;
+          row[x] = (alpha << 24) | (r << 16) | (g << 8) | b;
+        }
+      }
+    }
+
+    if (target_format == SDL_PIXELFORMAT_ARGB8888)
+      return argb;
+
+    /* reduced formats keep the top bits, the key survives as 1 bit alpha */
+    SDL_Surface * converted = SDL_ConvertSurfaceFormat (argb, target_format,
+                                                        0);
+    SDL_FreeSurface (argb);
+    return converted;
+  }
+
+  string TextureCache::getCacheFile (const string & path)
+  {
+    if (cache_dir.empty ())
+      return string ();
+
+    string root = GlobalDefs::getResourceRoot () + "/";
+    string name = path.compare (0, root.size (), root) ?
+        path : path.substr (root.size ());
+    for (char & c : name)
+      if (c == '/' || c == '\\' || c == ':')
+        c = '_';
+    return cache_dir + name + TEXTURE_CACHE_EXTENSION;
+  }
+
+  /* what the file has after the read position */
+  static size_t bytes_left (istream & in)
+  {
+    streampos pos = in.tellg ();
+    in.seekg (0, ios::end);
+    streampos end = in.tellg ();
+    in.seekg (pos);
+    if (pos < 0 || end < pos)
+      return 0;
+    return end - pos;
+  }
+
+  SDL_Surface * TextureCache::readCache (const string & cache_file,
+                                         Uint64 source_hash,
+                                         Uint32 target_format)
+  {
+    TRACE_ZONE ("TextureCache::readCache");
+    ifstream in (cache_file.c_str (), ios::binary);
+    if (!in.is_open ())
+      return NULL;
+
+    t_texture_cache_header header;
+    if (!in.read ((char *) &header, sizeof(header))
+        || header.magic != TEXTURE_CACHE_MAGIC
+        || header.version != TEXTURE_CACHE_VERSION
+        || header.source_hash != source_hash
+        || header.format != target_format
+        || ((header.flags & TEXTURE_CACHE_PREMULTIPLIED) != 0)
+            != premultiplied)
+      return NULL;
+    /* a truncated or corrupt blob is a miss, not an allocation */
+    if (header.data_size > bytes_left (in))
+      return NULL;
+
+    SDL_Surface * surface = SDL_CreateRGBSurfaceWithFormat (
+        0, header.width, header.height, SDL_BITSPERPIXEL(target_format),
+        target_format);
+    if (surface == NULL)
+      return NULL;
+    size_t raw_size = (size_t) surface->pitch * surface->h;
+
+    bool cache_ok = (Uint32) surface->pitch == header.pitch;
+    if (cache_ok && (header.flags & TEXTURE_CACHE_COMPRESSED))
+    {
+      vector<Uint8> packed (header.data_size);
+      cache_ok = in.read ((char *) packed.data (), packed.size ())
+          && lzDecompress (packed.data (), packed.size (),
+                           (Uint8 *) surface->pixels, raw_size);
+    }
+    else if (cache_ok)
+      cache_ok = header.data_size == raw_size
+          && in.read ((char *) surface->pixels, raw_size);
+
+    if (!cache_ok)
+    {
+      SDL_FreeSurface (surface);
+      return NULL;
+    }
+    return surface;
+  }
+
+  void TextureCache::writeCache (const string & cache_file,
+                                 Uint64 source_hash, SDL_Surface * surface)
+  {
+    t_texture_cache_header header;
+    header.magic = TEXTURE_CACHE_MAGIC;
+    header.version = TEXTURE_CACHE_VERSION;
+    header.flags = premultiplied ? TEXTURE_CACHE_PREMULTIPLIED : 0;
+    header.format = surface->format->format;
+    header.width = surface->w;
+    header.height = surface->h;
+    header.pitch = surface->pitch;
+    header.source_hash = source_hash;
+    header.reserved = 0;
+
+    const Uint8 * raw = (const Uint8 *) surface->pixels;
+    size_t raw_size = (size_t) surface->pitch * surface->h;
+    vector<Uint8> packed;
+    lzCompress (raw, raw_size, packed);
+
+    /* photos do not compress, store those as they are */
+    const Uint8 * data = raw;
+    header.data_size = raw_size;
+    if (packed.size () < raw_size)
+    {
+      header.flags |= TEXTURE_CACHE_COMPRESSED;
+      data = packed.data ();
+      header.data_size = packed.size ();
+    }
+
+    /* readers never see a half written file */
+    string temp_file = cache_file + ".tmp";
+    ofstream out (temp_file.c_str (), ios::binary | ios::trunc);
+    if (!out.is_open ())
+      return;
+    out.write ((const char *) &header, sizeof(header));
+    out.write ((const char *) data, header.data_size);
+    out.close ();
+    if (!out.good () || rename (temp_file.c_str (), cache_file.c_str ()))
+      remove (temp_file.c_str ());
+  }
+
+  SDL_Texture * TextureCache::createTexture (SDL_Renderer * renderer,
+                                             SDL_Surface * surface)
+  {
+    SDL_Texture * texture = SDL_CreateTexture (renderer,
+                                               surface->format->format,
+                                               SDL_TEXTUREACCESS_STATIC,
+                                               surface->w, surface->h);
+    if (texture == NULL)
+      return NULL;
+
+    if (SDL_UpdateTexture (texture, NULL, surface->pixels, surface->pitch))
+    {
+      SDL_DestroyTexture (texture);
+      return NULL;
+    }
+    SDL_SetTextureBlendMode (texture, blend_mode);
+
+    /* formats the renderer does not take are widened to 32 bit by SDL */
+    Uint32 texture_format = surface->format->format;
+    size_t pixels = (size_t) surface->w * surface->h;
+    t_texture_size size;
+    size.full_bytes = pixels * 4;
+    size.bytes = renderer_formats.count (texture_format) ?
+        pixels * SDL_BYTESPERPIXEL(texture_format) : size.full_bytes;
+    textures[texture] = size;
+    memory_usage.bytes += size.bytes;
+    memory_usage.full_bytes += size.full_bytes;
+    return texture;
+  }
+
+  void TextureCache::destroyTexture (SDL_Texture * texture)
+  {
+    map<SDL_Texture *, t_texture_size>::iterator it = textures.find (texture);
+    if (it != textures.end ())
+    {
+      memory_usage.bytes -= it->second.bytes;
+      memory_usage.full_bytes -= it->second.full_bytes;
+      textures.erase (it);
+    }
+    SDL_DestroyTexture (texture);
+  }
+
+  t_texture_size TextureCache::getMemoryUsage (void)
+  {
+    return memory_usage;
+  }
+
+  size_t TextureCache::getTextureBytes (SDL_Texture * texture)
+  {
+    if (!texture)
+      return 0;
+    map<SDL_Texture *, t_texture_size>::iterator it = textures.find (texture);
+    if (it != textures.end ())
+      return it->second.bytes;
+    Uint32 format;
+    int w, h;
+    if (SDL_QueryTexture (texture, &format, NULL, &w, &h))
+      return 0;
+    return (size_t) w * h * SDL_BYTESPERPIXEL(format);
+  }
+
+  void TextureCache::reportMemory (void)
+  {
+    printf ("Textures: %lu KB, %lu KB saved over 32 bit\n",
+            (unsigned long) (memory_usage.bytes / 1024),
+            (unsigned long) ((memory_usage.full_bytes - memory_usage.bytes)
+                / 1024));
+  }
+
+} /* namespace jumpinjack */
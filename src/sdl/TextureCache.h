@@ -0,0 +1,101 @@
+/*
+ * TextureCache.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef SDL_TEXTURECACHE_H_
+#define SDL_TEXTURECACHE_H_
+
+#include <string>
+#include <map>
+#include <set>
+#include <SDL2/SDL.h>
+
+/* baked images: colour key applied, premultiplied when the renderer can
+ * blend that way, already in the texture format and LZ compressed. One
+ * file per image in the user's pref path, rebuilt when the hash of the
+ * source file changes */
+#define TEXTURE_CACHE_MAGIC      0x544A4A4A
+#define TEXTURE_CACHE_VERSION    1
+#define TEXTURE_CACHE_EXTENSION  ".jjt"
+
+#define TEXTURE_CACHE_PREMULTIPLIED  1
+#define TEXTURE_CACHE_COMPRESSED     2
+
+/* per image (or *.ext) texture formats, anything else is 32 bit */
+#define TEXTURE_MANIFEST "textures.cfg"
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+      Uint32 magic;
+      Uint16 version;
+      Uint16 flags;
+      Uint32 format;
+      Uint32 width;
+      Uint32 height;
+      Uint32 pitch;
+      Uint64 source_hash;
+      Uint32 data_size;  /* bytes following the header */
+      Uint32 reserved;
+  } t_texture_cache_header;
+
+  typedef struct
+  {
+      size_t bytes;       /* as stored by the renderer */
+      size_t full_bytes;  /* had it been a 32 bit texture */
+  } t_texture_size;
+
+  class TextureCache
+  {
+    public:
+      /* picks the renderer's texture format and reads the manifest, call
+       * once before loading */
+      static void open (SDL_Renderer * renderer);
+
+      /* the manifest entry for this image, or the 32 bit native format */
+      static Uint32 getFormat (const std::string & path);
+
+      /* safe from any thread: decodes (or reads back) a baked surface */
+      static SDL_Surface * loadImage (const std::string & path);
+      /* render thread only, for surfaces returned by loadImage */
+      static SDL_Texture * createTexture (SDL_Renderer * renderer,
+                                          SDL_Surface * surface);
+      static void destroyTexture (SDL_Texture * texture);
+
+      /* textures created through createTexture that are still alive */
+      static t_texture_size getMemoryUsage (void);
+      /* textures created elsewhere are estimated from their format */
+      static size_t getTextureBytes (SDL_Texture * texture);
+      static void reportMemory (void);
+
+      static Uint64 hash (const Uint8 * data, size_t size);
+
+    private:
+      static void loadManifest (void);
+      static SDL_Surface * bake (SDL_Surface * decoded, Uint32 target_format);
+      static std::string getCacheFile (const std::string & path);
+      static SDL_Surface * readCache (const std::string & cache_file,
+                                      Uint64 source_hash,
+                                      Uint32 target_format);
+      static void writeCache (const std::string & cache_file,
+                              Uint64 source_hash, SDL_Surface * surface);
+
+      static std::string cache_dir;
+      static Uint32 format;
+      static bool premultiplied;
+      static SDL_BlendMode blend_mode;
+
+      static std::map<std::string, Uint32> manifest;
+      static std::set<Uint32> renderer_formats;
+      static std::map<SDL_Texture *, t_texture_size> textures;
+      static t_texture_size memory_usage;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* SDL_TEXTURECACHE_H_ */
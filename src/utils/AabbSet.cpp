@@ -0,0 +1,206 @@
+/*
+ * AabbSet.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "AabbSet.h"
+
+#include <cassert>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AABB_X86 1
+#include <immintrin.h>
+#endif
+
+namespace jumpinjack
+{
+
+  /* rounded up to whole blocks, the padding boxes are empty */
+  static size_t padded (size_t n)
+  {
+    return (n + AABB_BLOCK - 1) / AABB_BLOCK * AABB_BLOCK + AABB_BLOCK;
+  }
+
+  AabbSet::AabbSet () :
+      n_boxes (0)
+  {
+  }
+
+  void AabbSet::reserve (size_t n)
+  {
+    size_t capacity = padded (n);
+    min_x.reserve (capacity);
+    min_y.reserve (capacity);
+    max_x.reserve (capacity);
+    max_y.reserve (capacity);
+    layer.reserve (capacity);
+    mask.reserve (capacity);
+  }
+
+  void AabbSet::resize (size_t n)
+  {
+    size_t capacity = padded (n);
+    n_boxes = n;
+    min_x.assign (capacity, 0);
+    min_y.assign (capacity, 0);
+    max_x.assign (capacity, 0);
+    max_y.assign (capacity, 0);
+    layer.assign (capacity, 0);
+    mask.assign (capacity, 0);
+  }
+
+  size_t AabbSet::size (void) const
+  {
+    return n_boxes;
+  }
+
+  void AabbSet::set (size_t i, int32_t box_min_x, int32_t box_min_y,
+                     int32_t box_max_x, int32_t box_max_y, uint32_t box_layer,
+                     uint32_t box_mask)
+  {
+    assert (i < n_boxes);
+    min_x[i] = box_min_x;
+    min_y[i] = box_min_y;
+    max_x[i] = box_max_x;
+    max_y[i] = box_max_y;
+    layer[i] = box_layer;
+    mask[i] = box_mask;
+  }
+
+  uint32_t aabb_overlaps_scalar (const AabbSet & set, size_t i, size_t first)
+  {
+    uint32_t hits = 0;
+    for (size_t k = 0; k < AABB_BLOCK; k++)
+    {
+      size_t j = first + k;
+      bool apart = set.min_x[j] > set.max_x[i] || set.min_x[i] > set.max_x[j]
+          || set.min_y[j] > set.max_y[i] || set.min_y[i] > set.max_y[j];
+      bool interact = (set.mask[j] & set.layer[i])
+          || (set.mask[i] & set.layer[j]);
+      if (!apart && interact)
+        hits |= 1u << k;
+    }
+    return hits;
+  }
+
+#ifdef AABB_X86
+  /* four boxes per step, baseline on x86_64 */
+  __attribute__ ((target ("sse2")))
+  uint32_t aabb_overlaps_sse2 (const AabbSet & set, size_t i, size_t first)
+  {
+    const __m128i min_x = _mm_set1_epi32 (set.min_x[i]);
+    const __m128i min_y = _mm_set1_epi32 (set.min_y[i]);
+    const __m128i max_x = _mm_set1_epi32 (set.max_x[i]);
+    const __m128i max_y = _mm_set1_epi32 (set.max_y[i]);
+    const __m128i layer = _mm_set1_epi32 (set.layer[i]);
+    const __m128i mask = _mm_set1_epi32 (set.mask[i]);
+    const __m128i zero = _mm_setzero_si128 ();
+
+    uint32_t misses = 0;
+    for (size_t k = 0; k < AABB_BLOCK; k += 4)
+    {
+      size_t j = first + k;
+      __m128i j_min_x = _mm_loadu_si128 ((const __m128i *) &set.min_x[j]);
+      __m128i j_min_y = _mm_loadu_si128 ((const __m128i *) &set.min_y[j]);
+      __m128i j_max_x = _mm_loadu_si128 ((const __m128i *) &set.max_x[j]);
+      __m128i j_max_y = _mm_loadu_si128 ((const __m128i *) &set.max_y[j]);
+      __m128i j_layer = _mm_loadu_si128 ((const __m128i *) &set.layer[j]);
+      __m128i j_mask = _mm_loadu_si128 ((const __m128i *) &set.mask[j]);
+
+      __m128i apart = _mm_or_si128 (
+          _mm_or_si128 (_mm_cmpgt_epi32 (j_min_x, max_x),
+                        _mm_cmpgt_epi32 (min_x, j_max_x)),
+          _mm_or_si128 (_mm_cmpgt_epi32 (j_min_y, max_y),
+                        _mm_cmpgt_epi32 (min_y, j_max_y)));
+      __m128i deaf = _mm_and_si128 (
+          _mm_cmpeq_epi32 (_mm_and_si128 (j_mask, layer), zero),
+          _mm_cmpeq_epi32 (_mm_and_si128 (mask, j_layer), zero));
+      __m128i miss = _mm_or_si128 (apart, deaf);
+      misses |= (uint32_t) _mm_movemask_ps (_mm_castsi128_ps (miss)) << k;
+    }
+    return ~misses;
+  }
+
+  /* eight boxes per step */
+  __attribute__ ((target ("avx2")))
+  uint32_t aabb_overlaps_avx2 (const AabbSet & set, size_t i, size_t first)
+  {
+    const __m256i min_x = _mm256_set1_epi32 (set.min_x[i]);
+    const __m256i min_y = _mm256_set1_epi32 (set.min_y[i]);
+    const __m256i max_x = _mm256_set1_epi32 (set.max_x[i]);
+    const __m256i max_y = _mm256_set1_epi32 (set.max_y[i]);
+    const __m256i layer = _mm256_set1_epi32 (set.layer[i]);
+    const __m256i mask = _mm256_set1_epi32 (set.mask[i]);
+    const __m256i zero = _mm256_setzero_si256 ();
+
+    uint32_t misses = 0;
+    for (size_t k = 0; k < AABB_BLOCK; k += 8)
+    {
+      size_t j = first + k;
+      __m256i j_min_x = _mm256_loadu_si256 ((const __m256i *) &set.min_x[j]);
+      __m256i j_min_y = _mm256_loadu_si256 ((const __m256i *) &set.min_y[j]);
+      __m256i j_max_x = _mm256_loadu_si256 ((const __m256i *) &set.max_x[j]);
+      __m256i j_max_y = _mm256_loadu_si256 ((const __m256i *) &set.max_y[j]);
+      __m256i j_layer = _mm256_loadu_si256 ((const __m256i *) &set.layer[j]);
+      __m256i j_mask = _mm256_loadu_si256 ((const __m256i *) &set.mask[j]);
+
+      __m256i apart = _mm256_or_si256 (
+          _mm256_or_si256 (_mm256_cmpgt_epi32 (j_min_x, max_x),
+                           _mm256_cmpgt_epi32 (min_x, j_max_x)),
+          _mm256_or_si256 (_mm256_cmpgt_epi32 (j_min_y, max_y),
+                           _mm256_cmpgt_epi32 (min_y, j_max_y)));
+      __m256i deaf = _mm256_and_si256 (
+          _mm256_cmpeq_epi32 (_mm256_and_si256 (j_mask, layer), zero),
+          _mm256_cmpeq_epi32 (_mm256_and_si256 (mask, j_layer), zero));
+      __m256i miss = _mm256_or_si256 (apart, deaf);
+      misses |= (uint32_t) _mm256_movemask_ps (_mm256_castsi256_ps (miss))
+          << k;
+    }
+    return ~misses;
+  }
+#endif
+
+  AabbSet::t_kernel AabbSet::selectKernel (const char ** name)
+  {
+#ifdef AABB_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+    {
+      *name = "avx2";
+      return aabb_overlaps_avx2;
+    }
+    if (__builtin_cpu_supports ("sse2"))
+    {
+      *name = "sse2";
+      return aabb_overlaps_sse2;
+    }
+#endif
+    *name = "scalar";
+    return aabb_overlaps_scalar;
+  }
+
+  AabbSet::t_kernel AabbSet::getKernel (const char ** name)
+  {
+    static const char * kernel_name = 0;
+    static const t_kernel kernel = selectKernel (&kernel_name);
+    if (name)
+      *name = kernel_name;
+    return kernel;
+  }
+
+  uint32_t AabbSet::overlaps (size_t i, size_t first) const
+  {
+    assert (i < n_boxes && first < n_boxes);
+    return getKernel () (*this, i, first);
+  }
+
+  const char * AabbSet::getKernelName (void)
+  {
+    const char * name;
+    getKernel (&name);
+    return name;
+  }
+
+} /* namespace jumpinjack */
@@ -0,0 +1,68 @@
+/*
+ * AabbSet.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_AABBSET_H_
+#define UTILS_AABBSET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* overlaps () answers for this many boxes at once, the arrays are padded
+ * to it so the kernels never read past the end */
+#define AABB_BLOCK 32
+
+namespace jumpinjack
+{
+
+  /* boxes of a crowd as parallel arrays, with a layer and a mask each.
+   * Two boxes are candidates when they overlap, borders included, and
+   * either one's mask has a bit of the other's layer. Boxes with an
+   * empty layer and mask are never candidates */
+  class AabbSet
+  {
+    public:
+      AabbSet ();
+
+      void reserve (size_t n);
+      /* n boxes, all of them empty */
+      void resize (size_t n);
+      size_t size (void) const;
+      void set (size_t i, int32_t min_x, int32_t min_y, int32_t max_x,
+                int32_t max_y, uint32_t layer, uint32_t mask);
+
+      /* bit k set when box i and box first + k are candidates, for the
+       * AABB_BLOCK boxes from first on. SSE2 or AVX2 when the cpu has
+       * them, plain C++ otherwise */
+      uint32_t overlaps (size_t i, size_t first) const;
+      /* the kernel overlaps () runs, for reports */
+      static const char * getKernelName (void);
+
+      typedef uint32_t (*t_kernel) (const AabbSet & set, size_t i,
+                                    size_t first);
+
+    private:
+      static t_kernel selectKernel (const char ** name);
+      /* selected on first use */
+      static t_kernel getKernel (const char ** name = 0);
+
+      size_t n_boxes;
+      std::vector<int32_t> min_x;
+      std::vector<int32_t> min_y;
+      std::vector<int32_t> max_x;
+      std::vector<int32_t> max_y;
+      std::vector<uint32_t> layer;
+      std::vector<uint32_t> mask;
+
+      friend uint32_t aabb_overlaps_scalar (const AabbSet &, size_t, size_t);
+      friend uint32_t aabb_overlaps_sse2 (const AabbSet &, size_t, size_t);
+      friend uint32_t aabb_overlaps_avx2 (const AabbSet &, size_t, size_t);
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* UTILS_AABBSET_H_ */
@@ -0,0 +1,411 @@
+/*
+ * AllocTracker.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "AllocTracker.h"
+
+#ifdef JJ_ALLOC_TRACK
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+      atomic<uint64_t> allocs;
+      atomic<uint64_t> bytes;
+      atomic<uint64_t> steady;  /* violations */
+  } t_alloc_slot;
+
+  /* everything below is constant initialized: the hooks run before
+   * main and during static destruction */
+  static atomic<int> current_phase (-1);
+  static const char * phase_names[ALLOC_MAX_PHASES];
+  static atomic<int> phase_count (0);
+  /* the extra slot is "no phase" / "no zone" */
+  static t_alloc_slot phase_totals[ALLOC_MAX_PHASES + 1];
+  static atomic<uint64_t> frame_phase_allocs[ALLOC_MAX_PHASES + 1];
+  static atomic<const char *> zone_names[ALLOC_MAX_ZONES];
+  static t_alloc_slot zone_totals[ALLOC_MAX_ZONES + 1];
+
+  static atomic<uint64_t> frame_allocs (0);
+  static atomic<uint64_t> frame_bytes (0);
+  static atomic<uint64_t> frame_frees (0);
+
+  static atomic<bool> enforcing (false);
+  static atomic<bool> strict (false);
+  static bool steady_requested = false;
+  static int steady_frames = 0;
+
+  /* main thread only */
+  static t_alloc_frame last_frame;
+  static uint64_t frames = 0;
+  static uint64_t frames_allocating = 0;
+  static uint64_t max_allocs = 0;
+  static uint64_t max_bytes = 0;
+  static FILE * log_file = 0;
+  static bool log_header = false;
+
+  static thread_local const char * current_zone = 0;
+  /* set while the tracker itself prints, stdio allocates its buffers */
+  static thread_local bool busy = false;
+
+  /* zones are keyed by the address of their static name */
+  static size_t zone_slot (const char * name)
+  {
+    if (!name)
+      return ALLOC_MAX_ZONES;
+    size_t slot = ((uintptr_t) name >> 3) % ALLOC_MAX_ZONES;
+    for (size_t probe = 0; probe < ALLOC_MAX_ZONES; ++probe)
+    {
+      const char * key = zone_names[slot].load (memory_order_acquire);
+      if (key == name)
+        return slot;
+      if (!key)
+      {
+        const char * expected = 0;
+        if (zone_names[slot].compare_exchange_strong (expected, name)
+            || expected == name)
+          return slot;
+      }
+      slot = (slot + 1) % ALLOC_MAX_ZONES;
+    }
+    return ALLOC_MAX_ZONES;
+  }
+
+  static void add (t_alloc_slot & slot, size_t size, bool violation)
+  {
+    slot.allocs.fetch_add (1, memory_order_relaxed);
+    slot.bytes.fetch_add (size, memory_order_relaxed);
+    if (violation)
+      slot.steady.fetch_add (1, memory_order_relaxed);
+  }
+
+  static void fail (size_t size, int phase, const char * zone)
+  {
+    busy = true;
+    char message[256];
+    int length = snprintf (message, sizeof(message),
+                           "steady state allocation of %zu bytes in "
+                           "phase %s, zone %s\n", size,
+                           phase >= 0 && phase_names[phase] ?
+                               phase_names[phase] : "-",
+                           zone ? zone : "-");
+    if (length > 0)
+      (void) !write (STDERR_FILENO, message, min (length, 255));
+    abort ();
+  }
+
+  void AllocTracker::noteAlloc (size_t size)
+  {
+    if (busy)
+      return;
+    frame_allocs.fetch_add (1, memory_order_relaxed);
+    frame_bytes.fetch_add (size, memory_order_relaxed);
+
+    int phase = current_phase.load (memory_order_relaxed);
+    size_t phase_slot = phase >= 0 ? phase : ALLOC_MAX_PHASES;
+    bool violation = enforcing.load (memory_order_relaxed);
+    frame_phase_allocs[phase_slot].fetch_add (1, memory_order_relaxed);
+    add (phase_totals[phase_slot], size, violation);
+    add (zone_totals[zone_slot (current_zone)], size, violation);
+
+    if (violation && strict.load (memory_order_relaxed))
+      fail (size, phase, current_zone);
+  }
+
+  void AllocTracker::noteFree (void)
+  {
+    if (!busy)
+      frame_frees.fetch_add (1, memory_order_relaxed);
+  }
+
+  void AllocTracker::setPhase (int phase, const char * name)
+  {
+    assert (phase < ALLOC_MAX_PHASES);
+    if (phase >= 0)
+    {
+      phase_names[phase] = name;
+      if (phase >= phase_count.load (memory_order_relaxed))
+        phase_count.store (phase + 1, memory_order_relaxed);
+    }
+    current_phase.store (phase, memory_order_relaxed);
+  }
+
+  void AllocTracker::setSteady (bool steady)
+  {
+    steady_requested = steady;
+    if (!steady)
+      steady_frames = 0;
+    enforcing.store (steady && steady_frames >= ALLOC_WARMUP_FRAMES,
+                     memory_order_relaxed);
+  }
+
+  void AllocTracker::setStrict (bool on)
+  {
+    strict.store (on, memory_order_relaxed);
+  }
+
+  void AllocTracker::endFrame (void)
+  {
+    last_frame.allocs = frame_allocs.exchange (0, memory_order_relaxed);
+    last_frame.bytes = frame_bytes.exchange (0, memory_order_relaxed);
+    last_frame.frees = frame_frees.exchange (0, memory_order_relaxed);
+    if (steady_requested)
+      ++steady_frames;
+
+    ++frames;
+    if (last_frame.allocs)
+      ++frames_allocating;
+    max_allocs = max (max_allocs, last_frame.allocs);
+    max_bytes = max (max_bytes, last_frame.bytes);
+
+    uint64_t phase_allocs[ALLOC_MAX_PHASES + 1];
+    for (int phase = 0; phase <= ALLOC_MAX_PHASES; ++phase)
+      phase_allocs[phase] = frame_phase_allocs[phase].exchange (
+          0, memory_order_relaxed);
+    if (!log_file)
+      return;
+
+    busy = true;
+    int count = phase_count.load (memory_order_relaxed);
+    if (!log_header)
+    {
+      fprintf (log_file, "frame,allocs,bytes,frees");
+      for (int phase = 0; phase < count; ++phase)
+        fprintf (log_file, ",%s",
+                 phase_names[phase] ? phase_names[phase] : "-");
+      fprintf (log_file, ",other\n");
+      log_header = true;
+    }
+    fprintf (log_file, "%llu,%llu,%llu,%llu", (unsigned long long) frames,
+             (unsigned long long) last_frame.allocs,
+             (unsigned long long) last_frame.bytes,
+             (unsigned long long) last_frame.frees);
+    for (int phase = 0; phase < count; ++phase)
+      fprintf (log_file, ",%llu", (unsigned long long) phase_allocs[phase]);
+    fprintf (log_file, ",%llu\n",
+             (unsigned long long) phase_allocs[ALLOC_MAX_PHASES]);
+    busy = false;
+  }
+
+  const t_alloc_frame & AllocTracker::getLastFrame (void)
+  {
+    return last_frame;
+  }
+
+  bool AllocTracker::openLog (const char * path)
+  {
+    busy = true;
+    if (log_file)
+      fclose (log_file);
+    log_file = fopen (path, "w");
+    log_header = false;
+    busy = false;
+    return log_file != 0;
+  }
+
+  static void print_slot (const char * name, const t_alloc_slot & slot)
+  {
+    fprintf (stderr, "  %-32s %10llu %12llu %8llu\n", name,
+             (unsigned long long) slot.allocs.load (),
+             (unsigned long long) slot.bytes.load (),
+             (unsigned long long) slot.steady.load ());
+  }
+
+  void AllocTracker::report (void)
+  {
+    busy = true;
+    if (log_file)
+      fflush (log_file);
+
+    fprintf (stderr, "Allocations: %llu frames, %llu allocating, at most "
+             "%llu allocations / %llu bytes in one frame\n",
+             (unsigned long long) frames,
+             (unsigned long long) frames_allocating,
+             (unsigned long long) max_allocs,
+             (unsigned long long) max_bytes);
+
+    fprintf (stderr, "  %-32s %10s %12s %8s\n", "phase", "allocs", "bytes",
+             "steady");
+    int count = phase_count.load ();
+    for (int phase = 0; phase < count; ++phase)
+      if (phase_totals[phase].allocs.load ())
+        print_slot (phase_names[phase] ? phase_names[phase] : "-",
+                    phase_totals[phase]);
+    print_slot ("(none)", phase_totals[ALLOC_MAX_PHASES]);
+
+    /* busiest zones first */
+    size_t order[ALLOC_MAX_ZONES];
+    size_t zones = 0;
+    for (size_t slot = 0; slot < ALLOC_MAX_ZONES; ++slot)
+      if (zone_names[slot].load () && zone_totals[slot].allocs.load ())
+        order[zones++] = slot;
+    sort (order, order + zones, [] (size_t a, size_t b)
+    {
+      return zone_totals[a].allocs.load () > zone_totals[b].allocs.load ();
+    });
+    fprintf (stderr, "  %-32s %10s %12s %8s\n", "zone", "allocs", "bytes",
+             "steady");
+    for (size_t i = 0; i < zones; ++i)
+      print_slot (zone_names[order[i]].load (), zone_totals[order[i]]);
+    print_slot ("(none)", zone_totals[ALLOC_MAX_ZONES]);
+    busy = false;
+  }
+
+  const char * AllocTracker::enterZone (const char * name)
+  {
+    const char * previous = current_zone;
+    current_zone = name;
+    return previous;
+  }
+
+  void AllocTracker::leaveZone (const char * previous)
+  {
+    current_zone = previous;
+  }
+
+} /* namespace jumpinjack */
+
+/* glibc keeps the real allocator reachable under these names, so the
+ * definitions below interpose malloc for the whole process, SDL and its
+ * codecs included, without dlsym */
+extern "C"
+{
+  void * __libc_malloc (size_t size);
+  void * __libc_calloc (size_t count, size_t size);
+  void * __libc_realloc (void * ptr, size_t size);
+  void * __libc_memalign (size_t alignment, size_t size);
+  void __libc_free (void * ptr);
+
+  void * malloc (size_t size) throw ()
+  {
+    void * ptr = __libc_malloc (size);
+    if (ptr)
+      jumpinjack::AllocTracker::noteAlloc (size);
+    return ptr;
+  }
+
+  void * calloc (size_t count, size_t size) throw ()
+  {
+    void * ptr = __libc_calloc (count, size);
+    if (ptr)
+      jumpinjack::AllocTracker::noteAlloc (count * size);
+    return ptr;
+  }
+
+  void * realloc (void * ptr, size_t size) throw ()
+  {
+    void * resized = __libc_realloc (ptr, size);
+    if (resized)
+      jumpinjack::AllocTracker::noteAlloc (size);
+    else if (ptr && !size)
+      jumpinjack::AllocTracker::noteFree ();
+    return resized;
+  }
+
+  void * memalign (size_t alignment, size_t size) throw ()
+  {
+    void * ptr = __libc_memalign (alignment, size);
+    if (ptr)
+      jumpinjack::AllocTracker::noteAlloc (size);
+    return ptr;
+  }
+
+  void * aligned_alloc (size_t alignment, size_t size) throw ()
+  {
+    return memalign (alignment, size);
+  }
+
+  int posix_memalign (void ** ptr, size_t alignment, size_t size) throw ()
+  {
+    *ptr = memalign (alignment, size);
+    return *ptr ? 0 : 12 /* ENOMEM */;
+  }
+
+  void free (void * ptr) throw ()
+  {
+    if (ptr)
+      jumpinjack::AllocTracker::noteFree ();
+    __libc_free (ptr);
+  }
+}
+
+/* operator new goes to the real allocator directly so it is not counted
+ * a second time by malloc above */
+static void * tracked_new (size_t size)
+{
+  if (!size)
+    size = 1;
+  void * ptr;
+  while (!(ptr = __libc_malloc (size)))
+  {
+    std::new_handler handler = std::get_new_handler ();
+    if (!handler)
+      throw std::bad_alloc ();
+    handler ();
+  }
+  jumpinjack::AllocTracker::noteAlloc (size);
+  return ptr;
+}
+
+void * operator new (size_t size)
+{
+  return tracked_new (size);
+}
+
+void * operator new[] (size_t size)
+{
+  return tracked_new (size);
+}
+
+void * operator new (size_t size, const std::nothrow_t &) noexcept
+{
+  try
+  {
+    return tracked_new (size);
+  }
+  catch (...)
+  {
+    return 0;
+  }
+}
+
+void * operator new[] (size_t size, const std::nothrow_t &) noexcept
+{
+  return operator new (size, std::nothrow);
+}
+
+void operator delete (void * ptr) noexcept
+{
+  free (ptr);
+}
+
+void operator delete[] (void * ptr) noexcept
+{
+  free (ptr);
+}
+
+void operator delete (void * ptr, const std::nothrow_t &) noexcept
+{
+  free (ptr);
+}
+
+void operator delete[] (void * ptr, const std::nothrow_t &) noexcept
+{
+  free (ptr);
+}
+
+#endif /* JJ_ALLOC_TRACK */
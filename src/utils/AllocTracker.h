@@ -0,0 +1,109 @@
+/*
+ * AllocTracker.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_ALLOCTRACKER_H_
+#define UTILS_ALLOCTRACKER_H_
+
+/* heap allocation accounting, built with JJ_ALLOC_TRACK (make ALLOC=1).
+ * The build replaces operator new/delete and interposes malloc, so what
+ * SDL and the C++ runtime allocate is seen too. Without it the macros
+ * expand to nothing.
+ *
+ *   ALLOC_PHASE (id, "name");   frame phase for every thread, -1 for none
+ *   ALLOC_ZONE ("name");        scoped, per thread, static strings only
+ *   ALLOC_STEADY (on);          allocations while on are violations
+ *   ALLOC_STRICT (on);          violations abort with the phase and zone
+ *   ALLOC_FRAME_END ();         closes the frame's counters
+ *   ALLOC_LOG (file);           one csv line per frame, false on error
+ *   ALLOC_REPORT ();            totals by phase and zone on stderr
+ *
+ * TRACE_ZONE opens an ALLOC_ZONE as well.
+ */
+
+#ifdef JJ_ALLOC_TRACK
+
+#include <cstddef>
+#include <cstdint>
+
+#define ALLOC_MAX_PHASES 16
+#define ALLOC_MAX_ZONES  128
+/* steady frames allowed to allocate while containers reach their size */
+#define ALLOC_WARMUP_FRAMES 60
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+      uint64_t allocs;
+      uint64_t bytes;
+      uint64_t frees;
+  } t_alloc_frame;
+
+  class AllocTracker
+  {
+    public:
+      /* called from the hooks, must not allocate */
+      static void noteAlloc (size_t size);
+      static void noteFree (void);
+
+      static void setPhase (int phase, const char * name);
+      static void setSteady (bool steady);
+      static void setStrict (bool strict);
+      static void endFrame (void);
+
+      static const t_alloc_frame & getLastFrame (void);
+      static bool openLog (const char * path);
+      static void report (void);
+
+      /* per thread, returns the enclosing zone */
+      static const char * enterZone (const char * name);
+      static void leaveZone (const char * previous);
+  };
+
+  class AllocZone
+  {
+    public:
+      AllocZone (const char * name) :
+          previous (AllocTracker::enterZone (name))
+      {
+      }
+      ~AllocZone ()
+      {
+        AllocTracker::leaveZone (previous);
+      }
+
+    private:
+      const char * previous;
+  };
+
+} /* namespace jumpinjack */
+
+#define ALLOC_JOIN2(a, b) a##b
+#define ALLOC_JOIN(a, b) ALLOC_JOIN2(a, b)
+#define ALLOC_PHASE(id, name) ::jumpinjack::AllocTracker::setPhase (id, name)
+#define ALLOC_ZONE(name) \
+  ::jumpinjack::AllocZone ALLOC_JOIN(alloc_zone_, __LINE__) (name)
+#define ALLOC_STEADY(on) ::jumpinjack::AllocTracker::setSteady (on)
+#define ALLOC_STRICT(on) ::jumpinjack::AllocTracker::setStrict (on)
+#define ALLOC_FRAME_END() ::jumpinjack::AllocTracker::endFrame ()
+#define ALLOC_LOG(path) ::jumpinjack::AllocTracker::openLog (path)
+#define ALLOC_REPORT() ::jumpinjack::AllocTracker::report ()
+
+#else
+
+#define ALLOC_PHASE(id, name)
+#define ALLOC_ZONE(name)
+#define ALLOC_STEADY(on)
+#define ALLOC_STRICT(on)
+#define ALLOC_FRAME_END()
+#define ALLOC_LOG(path) (false)
+#define ALLOC_REPORT()
+
+#endif /* JJ_ALLOC_TRACK */
+
+#endif /* UTILS_ALLOCTRACKER_H_ */
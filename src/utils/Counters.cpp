@@ -0,0 +1,167 @@
+/*
+ * Counters.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "Counters.h"
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  static const struct
+  {
+      const char * name;
+      t_counter_kind kind;
+  } counter_info[COUNTER_COUNT] =
+    {
+      { "test_pixel", COUNTER_KIND_EVENT },
+      { "can_move_to", COUNTER_KIND_EVENT },
+      { "collision_tests", COUNTER_KIND_EVENT },
+      { "collision_hits", COUNTER_KIND_EVENT },
+      { "items_passive", COUNTER_KIND_GAUGE },
+      { "items_projectile", COUNTER_KIND_GAUGE },
+      { "items_player", COUNTER_KIND_GAUGE },
+      { "items_enemy", COUNTER_KIND_GAUGE },
+      { "items_check", COUNTER_KIND_GAUGE },
+      { "draw_calls", COUNTER_KIND_EVENT },
+      { "texture_switches", COUNTER_KIND_EVENT },
+      { "spawns", COUNTER_KIND_EVENT },
+      { "frees", COUNTER_KIND_EVENT },
+      { "sounds", COUNTER_KIND_EVENT },
+      { "arena_bytes", COUNTER_KIND_GAUGE } };
+
+  thread_local uint64_t Counters::frame_values[COUNTER_COUNT];
+  uint64_t Counters::last_frame[COUNTER_COUNT];
+  uint64_t Counters::totals[COUNTER_COUNT];
+  uint64_t Counters::frame = 0;
+  thread_local const void * Counters::last_texture = 0;
+  t_stats_segment * Counters::segment = 0;
+  char Counters::segment_name[STATS_NAME_LENGTH];
+
+  void Counters::endFrame (void)
+  {
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+      last_frame[c] = frame_values[c];
+      if (counter_info[c].kind == COUNTER_KIND_EVENT)
+      {
+        totals[c] += frame_values[c];
+        frame_values[c] = 0;
+      }
+      else
+        totals[c] = frame_values[c];
+    }
+    ++frame;
+    last_texture = 0;
+
+    if (!segment)
+      return;
+
+    uint32_t sequence = segment->sequence.load (memory_order_relaxed);
+    segment->sequence.store (sequence + 1, memory_order_relaxed);
+    atomic_thread_fence (memory_order_release);
+
+    segment->frame.store (frame, memory_order_relaxed);
+    segment->timestamp_ns.store (
+        chrono::duration_cast<chrono::nanoseconds> (
+            chrono::steady_clock::now ().time_since_epoch ()).count (),
+        memory_order_relaxed);
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+      segment->totals[c].store (totals[c], memory_order_relaxed);
+      segment->last_frame[c].store (last_frame[c], memory_order_relaxed);
+    }
+
+    segment->sequence.store (sequence + 2, memory_order_release);
+  }
+
+  uint64_t Counters::getLastFrame (t_counter counter)
+  {
+    return last_frame[counter];
+  }
+
+  uint64_t Counters::getTotal (t_counter counter)
+  {
+    return totals[counter];
+  }
+
+  const char * Counters::getName (t_counter counter)
+  {
+    return counter_info[counter].name;
+  }
+
+  t_counter_kind Counters::getKind (t_counter counter)
+  {
+    return counter_info[counter].kind;
+  }
+
+  bool Counters::openSegment (const char * name)
+  {
+    closeSegment ();
+
+    int fd = shm_open (name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+      return false;
+    if (ftruncate (fd, sizeof(t_stats_segment)) < 0)
+    {
+      close (fd);
+      shm_unlink (name);
+      return false;
+    }
+    void * mapping = mmap (0, sizeof(t_stats_segment), PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+    close (fd);
+    if (mapping == MAP_FAILED)
+    {
+      shm_unlink (name);
+      return false;
+    }
+
+    /* readers check the magic last */
+    segment = new (mapping) t_stats_segment;
+    segment->magic = 0;
+    segment->version = STATS_SEGMENT_VERSION;
+    segment->counter_count = COUNTER_COUNT;
+    segment->pid = getpid ();
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+      segment->kinds[c] = counter_info[c].kind;
+      strncpy (segment->names[c], counter_info[c].name, STATS_NAME_LENGTH - 1);
+      segment->names[c][STATS_NAME_LENGTH - 1] = '\0';
+      segment->totals[c].store (0, memory_order_relaxed);
+      segment->last_frame[c].store (0, memory_order_relaxed);
+    }
+    segment->frame.store (0, memory_order_relaxed);
+    segment->timestamp_ns.store (0, memory_order_relaxed);
+    segment->sequence.store (0, memory_order_relaxed);
+    atomic_thread_fence (memory_order_release);
+    segment->magic = STATS_SEGMENT_MAGIC;
+
+    strncpy (segment_name, name, STATS_NAME_LENGTH - 1);
+    segment_name[STATS_NAME_LENGTH - 1] = '\0';
+    return true;
+  }
+
+  void Counters::closeSegment (void)
+  {
+    if (!segment)
+      return;
+    munmap (segment, sizeof(t_stats_segment));
+    shm_unlink (segment_name);
+    segment = 0;
+  }
+
+} /* namespace jumpinjack */
@@ -0,0 +1,112 @@
+/*
+ * Counters.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_COUNTERS_H_
+#define UTILS_COUNTERS_H_
+
+#include <cstdint>
+#include <atomic>
+
+/* published every frame, see tools/jjstat.cpp */
+#define STATS_SEGMENT_NAME     "/jumpinjack-stats"
+#define STATS_SEGMENT_MAGIC    0x53544A4A
+#define STATS_SEGMENT_VERSION  2
+#define STATS_NAME_LENGTH      32
+
+namespace jumpinjack
+{
+
+  typedef enum
+  {
+    COUNTER_TEST_PIXEL,
+    COUNTER_CAN_MOVE_TO,
+    COUNTER_COLLISION_TESTS,
+    COUNTER_COLLISION_HITS,
+    COUNTER_ITEMS_PASSIVE,
+    COUNTER_ITEMS_PROJECTILE,
+    COUNTER_ITEMS_PLAYER,
+    COUNTER_ITEMS_ENEMY,
+    COUNTER_ITEMS_CHECK,
+    COUNTER_DRAW_CALLS,
+    COUNTER_TEXTURE_SWITCHES,
+    COUNTER_SPAWNS,
+    COUNTER_FREES,
+    COUNTER_SOUNDS,
+    COUNTER_ARENA_BYTES,
+    COUNTER_COUNT
+  } t_counter;
+
+  typedef enum
+  {
+    COUNTER_KIND_EVENT,  /* accumulates, readers show a rate */
+    COUNTER_KIND_GAUGE   /* a level, readers show the value */
+  } t_counter_kind;
+
+  /* shared memory layout. The writer bumps sequence to odd, updates and
+   * bumps it to even again; readers retry while it is odd or moved */
+  typedef struct
+  {
+      uint32_t magic;
+      uint32_t version;
+      uint32_t counter_count;
+      uint32_t pid;
+      uint32_t kinds[COUNTER_COUNT];
+      char names[COUNTER_COUNT][STATS_NAME_LENGTH];
+
+      std::atomic<uint32_t> sequence;
+      std::atomic<uint64_t> frame;
+      std::atomic<uint64_t> timestamp_ns;
+      std::atomic<uint64_t> totals[COUNTER_COUNT];
+      std::atomic<uint64_t> last_frame[COUNTER_COUNT];
+  } t_stats_segment;
+
+  /* hot path counters. Counted per thread and only the main thread's are
+   * published: parallel sections add their per chunk totals once they
+   * are joined, batched levels stepped on workers go uncounted */
+  class Counters
+  {
+    public:
+      static inline void add (t_counter counter, uint64_t n = 1)
+      {
+        frame_values[counter] += n;
+      }
+      static inline void set (t_counter counter, uint64_t value)
+      {
+        frame_values[counter] = value;
+      }
+      static inline void draw (const void * texture)
+      {
+        ++frame_values[COUNTER_DRAW_CALLS];
+        if (texture != last_texture)
+          ++frame_values[COUNTER_TEXTURE_SWITCHES];
+        last_texture = texture;
+      }
+
+      /* closes the frame: totals, publish, reset */
+      static void endFrame (void);
+      static uint64_t getLastFrame (t_counter counter);
+      static uint64_t getTotal (t_counter counter);
+      static const char * getName (t_counter counter);
+      static t_counter_kind getKind (t_counter counter);
+
+      static bool openSegment (const char * name);
+      static void closeSegment (void);
+
+    private:
+      static thread_local uint64_t frame_values[COUNTER_COUNT];
+      static uint64_t last_frame[COUNTER_COUNT];
+      static uint64_t totals[COUNTER_COUNT];
+      static uint64_t frame;
+      static thread_local const void * last_texture;
+
+      static t_stats_segment * segment;
+      static char segment_name[STATS_NAME_LENGTH];
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* UTILS_COUNTERS_H_ */
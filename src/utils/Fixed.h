@@ -0,0 +1,123 @@
+/*
+ * Fixed.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_FIXED_H_
+#define UTILS_FIXED_H_
+
+#include <cstdint>
+
+/* 16.16 fixed point: positions and speeds in 1/65536 of a pixel. Only
+ * integer operations, so a simulation gives the same bits whatever the
+ * compiler or the floating point settings */
+#define FIXED_SHIFT    16
+#define FIXED_ONE      (1 << FIXED_SHIFT)
+#define FIXED_FRACTION (FIXED_ONE - 1)
+
+namespace jumpinjack
+{
+
+  typedef int32_t t_fixed;
+
+  typedef struct
+  {
+      t_fixed x;
+      t_fixed y;
+  } t_fixed_point;
+
+  constexpr t_fixed toFixed (int value)
+  {
+    return value * FIXED_ONE;
+  }
+
+  /* toward minus infinity, so that fixedFloor (v) * FIXED_ONE
+   * + fixedFraction (v) == v also for negative values */
+  constexpr int fixedFloor (t_fixed value)
+  {
+    return (value - (value & FIXED_FRACTION)) / FIXED_ONE;
+  }
+
+  constexpr t_fixed fixedFraction (t_fixed value)
+  {
+    return value & FIXED_FRACTION;
+  }
+
+  inline t_fixed fixedMul (t_fixed a, t_fixed b)
+  {
+    return (t_fixed) ((int64_t) a * b / FIXED_ONE);
+  }
+
+  /* whole pixels and what is left, in the two halves items keep */
+  inline void fixedSplit (t_fixed value, int & whole, t_fixed & fraction)
+  {
+    whole = fixedFloor (value);
+    fraction = fixedFraction (value);
+  }
+
+  /* sine by whole degrees. The quarter wave is built at compile time from
+   * a Taylor series, so the table is the same on every build */
+  namespace fixed_trig
+  {
+    constexpr double taylor_sin (double x, double term, int n, double sum)
+    {
+      return n > 12 ? sum :
+          taylor_sin (x, -term * x * x / ((2 * n) * (2 * n + 1)), n + 1,
+                      sum + term);
+    }
+
+    constexpr t_fixed quarter_sin (int degrees)
+    {
+      return (t_fixed) (taylor_sin (degrees * 3.14159265358979323846 / 180,
+                                    degrees * 3.14159265358979323846 / 180,
+                                    1, 0.0) * FIXED_ONE + 0.5);
+    }
+
+    template<int ... I>
+      struct table
+      {
+          static constexpr t_fixed values[sizeof...(I)] =
+            { quarter_sin (I)... };
+      };
+    template<int ... I>
+      constexpr t_fixed table<I...>::values[sizeof...(I)];
+
+    template<int N, int ... I>
+      struct make_table : make_table<N - 1, N - 1, I...>
+      {
+      };
+    template<int ... I>
+      struct make_table<0, I...>
+      {
+          typedef table<I...> type;
+      };
+
+    /* 0 to 90 degrees */
+    typedef make_table<91>::type quarter;
+  }
+
+  inline t_fixed fixedSin (int degrees)
+  {
+    const t_fixed * quarter = fixed_trig::quarter::values;
+    degrees %= 360;
+    if (degrees < 0)
+      degrees += 360;
+    if (degrees <= 90)
+      return quarter[degrees];
+    if (degrees <= 180)
+      return quarter[180 - degrees];
+    if (degrees <= 270)
+      return -quarter[degrees - 180];
+    return -quarter[360 - degrees];
+  }
+
+  inline t_fixed fixedCos (int degrees)
+  {
+    return fixedSin (degrees % 360 + 90);
+  }
+
+} /* namespace jumpinjack */
+
+#endif /* UTILS_FIXED_H_ */
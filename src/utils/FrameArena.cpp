@@ -0,0 +1,97 @@
+/*
+ * FrameArena.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "FrameArena.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  FrameArena::FrameArena (size_t size) :
+      capacity (size), used (0), spilled (0), live (0)
+  {
+    buffer = (char *) malloc (capacity);
+    assert (buffer);
+  }
+
+  FrameArena::~FrameArena ()
+  {
+    ::free (buffer);
+  }
+
+  void * FrameArena::allocate (size_t size, size_t align)
+  {
+    live.fetch_add (1, memory_order_relaxed);
+    size_t start;
+    size_t offset = used.load (memory_order_relaxed);
+    do
+    {
+      start = (offset + align - 1) & ~(align - 1);
+      if (start + size > capacity)
+      {
+        /* malloc alignment covers everything the game stores here */
+        assert (align <= FRAME_ARENA_ALIGN);
+        spilled.fetch_add (size, memory_order_relaxed);
+        return malloc (size);
+      }
+    } while (!used.compare_exchange_weak (offset, start + size,
+                                          memory_order_relaxed));
+    return buffer + start;
+  }
+
+  void FrameArena::deallocate (void * ptr, size_t size)
+  {
+    if (!ptr)
+      return;
+    live.fetch_sub (1, memory_order_relaxed);
+    char * block = (char *) ptr;
+    if (block < buffer || block >= buffer + capacity)
+    {
+      ::free (ptr);
+      return;
+    }
+    size_t end = block - buffer + size;
+    used.compare_exchange_strong (end, block - buffer,
+                                  memory_order_relaxed);
+  }
+
+  void FrameArena::reset (void)
+  {
+    assert (live.load () == 0);
+    size_t peak = getUsed ();
+    if (spilled.load (memory_order_relaxed))
+    {
+      /* spills also come from space lost to alignment and growth */
+      do
+        capacity *= 2;
+      while (capacity < peak);
+      ::free (buffer);
+      buffer = (char *) malloc (capacity);
+      assert (buffer);
+      printf ("Frame arena grown to %zu KB\n", capacity / 1024);
+    }
+    used.store (0, memory_order_relaxed);
+    spilled.store (0, memory_order_relaxed);
+  }
+
+  size_t FrameArena::getUsed (void) const
+  {
+    return used.load (memory_order_relaxed)
+        + spilled.load (memory_order_relaxed);
+  }
+
+  size_t FrameArena::getCapacity (void) const
+  {
+    return capacity;
+  }
+
+} /* namespace jumpinjack */
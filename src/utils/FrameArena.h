@@ -0,0 +1,120 @@
+/*
+ * FrameArena.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_FRAMEARENA_H_
+#define UTILS_FRAMEARENA_H_
+
+#include <cstddef>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+#define FRAME_ARENA_SIZE  (256 * 1024)
+#define FRAME_ARENA_ALIGN 16
+
+namespace jumpinjack
+{
+
+  /* bump allocator for data that lives one frame, reset by
+   * SdlManager::startLoop. allocate () is thread safe, so collision
+   * workers can fill their chunks from it. A frame that does not fit
+   * spills to the heap and the next reset grows the arena to the peak.
+   *
+   * Containers on the arena must be emptied with release () before the
+   * reset, reset () asserts nothing is still allocated */
+  class FrameArena
+  {
+    public:
+      FrameArena (size_t size = FRAME_ARENA_SIZE);
+      virtual ~FrameArena ();
+
+      void * allocate (size_t size, size_t align = FRAME_ARENA_ALIGN);
+      /* gives the space back when it is the last block, which makes
+       * vector growth cheap */
+      void deallocate (void * ptr, size_t size);
+      void reset (void);
+
+      /* bytes this frame, spills included */
+      size_t getUsed (void) const;
+      size_t getCapacity (void) const;
+
+      /* frees the storage of an arena backed container now */
+      template<typename C>
+      static void release (C & container)
+      {
+        C (container.get_allocator ()).swap (container);
+      }
+
+    private:
+      char * buffer;
+      size_t capacity;
+      std::atomic<size_t> used;
+      std::atomic<size_t> spilled;
+      std::atomic<int> live;
+  };
+
+  /* std allocator over a FrameArena, plain heap when the arena is null.
+   * It follows assignment, so a container is moved to an arena by
+   * assigning it an empty one built on it */
+  template<typename T>
+  class ArenaAllocator
+  {
+    public:
+      typedef T value_type;
+      typedef std::true_type propagate_on_container_copy_assignment;
+      typedef std::true_type propagate_on_container_move_assignment;
+      typedef std::true_type propagate_on_container_swap;
+
+      ArenaAllocator (FrameArena * arena = 0) :
+          arena (arena)
+      {
+      }
+      template<typename U>
+      ArenaAllocator (const ArenaAllocator<U> & other) :
+          arena (other.arena)
+      {
+      }
+
+      T * allocate (size_t n)
+      {
+        if (!arena)
+          return (T *) ::operator new (n * sizeof(T));
+        return (T *) arena->allocate (n * sizeof(T),
+                                      alignof(T) > FRAME_ARENA_ALIGN ?
+                                          alignof(T) : FRAME_ARENA_ALIGN);
+      }
+      void deallocate (T * ptr, size_t n)
+      {
+        if (!arena)
+          ::operator delete (ptr);
+        else
+          arena->deallocate (ptr, n * sizeof(T));
+      }
+
+      FrameArena * arena;
+  };
+
+  template<typename T, typename U>
+  inline bool operator== (const ArenaAllocator<T> & a,
+                          const ArenaAllocator<U> & b)
+  {
+    return a.arena == b.arena;
+  }
+
+  template<typename T, typename U>
+  inline bool operator!= (const ArenaAllocator<T> & a,
+                          const ArenaAllocator<U> & b)
+  {
+    return a.arena != b.arena;
+  }
+
+  template<typename T>
+  using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+} /* namespace jumpinjack */
+
+#endif /* UTILS_FRAMEARENA_H_ */
@@ -0,0 +1,161 @@
+/*
+ * Lz.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "Lz.h"
+
+#include <cstring>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  static inline uint32_t read32 (const uint8_t * p)
+  {
+    uint32_t value;
+    memcpy (&value, p, sizeof(value));
+    return value;
+  }
+
+  static inline uint32_t lz_hash (uint32_t value)
+  {
+    return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+  }
+
+  static void put_length (size_t length, vector<uint8_t> & out)
+  {
+    for (; length >= 255; length -= 255)
+      out.push_back (255);
+    out.push_back ((uint8_t) length);
+  }
+
+  static void put_sequence (const uint8_t * literals, size_t literal_length,
+                            size_t offset, size_t match_length,
+                            vector<uint8_t> & out)
+  {
+    size_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+    uint8_t token = (literal_length < 15 ? literal_length : 15) << 4;
+    token |= match_code < 15 ? match_code : 15;
+    out.push_back (token);
+    if (literal_length >= 15)
+      put_length (literal_length - 15, out);
+    out.insert (out.end (), literals, literals + literal_length);
+
+    /* the last sequence carries literals only */
+    if (!match_length)
+      return;
+    out.push_back (offset & 0xFF);
+    out.push_back (offset >> 8);
+    if (match_code >= 15)
+      put_length (match_code - 15, out);
+  }
+
+  void lzCompress (const uint8_t * in, size_t in_size, vector<uint8_t> & out)
+  {
+    size_t table[1 << LZ_HASH_BITS];
+    for (size_t & entry : table)
+      entry = (size_t) -1;
+
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (in_size >= LZ_MIN_MATCH && pos <= in_size - LZ_MIN_MATCH)
+    {
+      uint32_t sequence = read32 (in + pos);
+      size_t & slot = table[lz_hash (sequence)];
+      size_t candidate = slot;
+      slot = pos;
+
+      if (candidate == (size_t) -1 || pos - candidate > LZ_MAX_OFFSET
+          || read32 (in + candidate) != sequence)
+      {
+        ++pos;
+        continue;
+      }
+
+      size_t match_length = LZ_MIN_MATCH;
+      while (pos + match_length < in_size
+          && in[candidate + match_length] == in[pos + match_length])
+        ++match_length;
+
+      put_sequence (in + anchor, pos - anchor, pos - candidate, match_length,
+                    out);
+      pos += match_length;
+      anchor = pos;
+    }
+
+    put_sequence (in + anchor, in_size - anchor, 0, 0, out);
+  }
+
+  static bool get_length (const uint8_t *& in, const uint8_t * in_end,
+                          size_t & length)
+  {
+    uint8_t byte;
+    do
+    {
+      if (in == in_end)
+        return false;
+      byte = *in++;
+      length += byte;
+    } while (byte == 255);
+    return true;
+  }
+
+  bool lzDecompress (const uint8_t * in, size_t in_size, uint8_t * out,
+                     size_t out_size)
+  {
+    const uint8_t * in_end = in + in_size;
+    uint8_t * out_start = out;
+    uint8_t * out_end = out + out_size;
+
+    while (in < in_end)
+    {
+      uint8_t token = *in++;
+
+      size_t literal_length = token >> 4;
+      if (literal_length == 15 && !get_length (in, in_end, literal_length))
+        return false;
+      if ((size_t) (in_end - in) < literal_length
+          || (size_t) (out_end - out) < literal_length)
+        return false;
+      memcpy (out, in, literal_length);
+      in += literal_length;
+      out += literal_length;
+
+      if (in == in_end)
+        break;
+
+      if (in_end - in < 2)
+        return false;
+      size_t offset = in[0] | (in[1] << 8);
+      in += 2;
+      size_t match_length = token & 0x0F;
+      if (match_length == 15 && !get_length (in, in_end, match_length))
+        return false;
+      match_length += LZ_MIN_MATCH;
+
+      if (!offset || offset > (size_t) (out - out_start)
+          || (size_t) (out_end - out) < match_length)
+        return false;
+
+      /* may overlap: the copied span doubles every round, so runs of a
+       * single pixel still go through memcpy */
+      const uint8_t * match = out - offset;
+      while (match_length)
+      {
+        size_t chunk = out - match;
+        if (chunk > match_length)
+          chunk = match_length;
+        memcpy (out, match, chunk);
+        out += chunk;
+        match_length -= chunk;
+      }
+    }
+
+    return out == out_end;
+  }
+
+} /* namespace jumpinjack */
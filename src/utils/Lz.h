@@ -0,0 +1,37 @@
+/*
+ * Lz.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_LZ_H_
+#define UTILS_LZ_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* LZ4 style block: a token with 4 bit literal and match lengths, the
+ * literals, a 16 bit little endian offset and the extra length bytes.
+ * Made for speed of decoding, not ratio */
+#define LZ_MIN_MATCH   4
+#define LZ_MAX_OFFSET  65535
+#define LZ_HASH_BITS   12
+/* no byte of a block decodes to more than this many */
+#define LZ_MAX_EXPANSION 255
+
+namespace jumpinjack
+{
+
+  /* appends the compressed block to out */
+  void lzCompress (const uint8_t * in, size_t in_size,
+                   std::vector<uint8_t> & out);
+
+  /* false on corrupt input or if it does not decode to exactly out_size */
+  bool lzDecompress (const uint8_t * in, size_t in_size, uint8_t * out,
+                     size_t out_size);
+
+} /* namespace jumpinjack */
+
+#endif /* UTILS_LZ_H_ */
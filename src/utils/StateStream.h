@@ -0,0 +1,143 @@
+/*
+ * StateStream.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_STATESTREAM_H_
+#define UTILS_STATESTREAM_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace jumpinjack
+{
+
+  /* simulation state as plain bytes, for replay keyframes. Values are
+   * copied as they are in memory: a state is only read back by the same
+   * build that wrote it */
+  class StateWriter
+  {
+    public:
+      StateWriter (std::vector<uint8_t> & buffer) :
+          buffer (buffer)
+      {
+      }
+
+      template<typename T>
+        void put (const T & value)
+        {
+          static_assert (std::is_trivially_copyable<T>::value,
+                         "state values are copied as bytes");
+          const uint8_t * bytes = (const uint8_t *) &value;
+          buffer.insert (buffer.end (), bytes, bytes + sizeof(T));
+        }
+      void putString (const std::string & value)
+      {
+        put ((uint32_t) value.size ());
+        buffer.insert (buffer.end (), value.begin (), value.end ());
+      }
+
+    private:
+      std::vector<uint8_t> & buffer;
+  };
+
+  /* a short or corrupt state leaves the reader failed () and the values
+   * zeroed, it never reads past the end */
+  class StateReader
+  {
+    public:
+      StateReader (const uint8_t * data, size_t size) :
+          data (data), size (size), pos (0), error (false)
+      {
+      }
+
+      template<typename T>
+        bool get (T & value)
+        {
+          static_assert (std::is_trivially_copyable<T>::value,
+                         "state values are copied as bytes");
+          if (error || size - pos < sizeof(T))
+          {
+            error = true;
+            memset ((void *) &value, 0, sizeof(T));
+            return false;
+          }
+          memcpy ((void *) &value, data + pos, sizeof(T));
+          pos += sizeof(T);
+          return true;
+        }
+      bool getString (std::string & value)
+      {
+        uint32_t length;
+        if (!get (length) || size - pos < length)
+        {
+          error = true;
+          value.clear ();
+          return false;
+        }
+        value.assign ((const char *) data + pos, length);
+        pos += length;
+        return true;
+      }
+
+      bool failed (void) const
+      {
+        return error;
+      }
+      bool atEnd (void) const
+      {
+        return pos == size;
+      }
+      /* bytes not read yet, to check counts before sizing for them */
+      size_t remaining (void) const
+      {
+        return size - pos;
+      }
+
+    private:
+      const uint8_t * data;
+      size_t size;
+      size_t pos;
+      bool error;
+  };
+
+  /* FNV-1a over the same values a StateWriter would write, for per tick
+   * state hashes without building the state */
+  class StateHasher
+  {
+    public:
+      StateHasher () :
+          value (14695981039346656037ULL)
+      {
+      }
+
+      template<typename T>
+        void put (const T & field)
+        {
+          static_assert (std::is_trivially_copyable<T>::value,
+                         "state values are hashed as bytes");
+          const uint8_t * bytes = (const uint8_t *) &field;
+          for (size_t i = 0; i < sizeof(T); ++i)
+          {
+            value ^= bytes[i];
+            value *= 1099511628211ULL;
+          }
+        }
+
+      uint64_t get (void) const
+      {
+        return value;
+      }
+
+    private:
+      uint64_t value;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* UTILS_STATESTREAM_H_ */
@@ -0,0 +1,162 @@
+/*
+ * ThreadPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "ThreadPool.h"
+#include "Tracer.h"
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  ThreadPool::ThreadPool (int n_threads) :
+      running (0), stop (false)
+  {
+    if (n_threads <= 0)
+      n_threads = max (1, (int) thread::hardware_concurrency ());
+
+    /* the calling thread also runs tasks while waiting */
+    workers.reserve (n_threads - 1);
+    for (int i = 1; i < n_threads; ++i)
+      workers.push_back (thread (&ThreadPool::workerLoop, this));
+  }
+
+  ThreadPool::~ThreadPool ()
+  {
+    {
+      unique_lock<mutex> lock (queue_mutex);
+      stop = true;
+    }
+    task_ready.notify_all ();
+    for (thread & worker : workers)
+      worker.join ();
+  }
+
+  int ThreadPool::getThreadCount (void) const
+  {
+    return workers.size () + 1;
+  }
+
+  void ThreadPool::submit (t_task task)
+  {
+    if (workers.empty ())
+    {
+      task ();
+      return;
+    }
+    {
+      unique_lock<mutex> lock (queue_mutex);
+      tasks.push_back (task);
+    }
+    task_ready.notify_one ();
+  }
+
+  bool ThreadPool::runPending (unique_lock<mutex> & lock)
+  {
+    if (tasks.empty ())
+      return false;
+
+    t_task task = tasks.front ();
+    tasks.pop_front ();
+    ++running;
+    lock.unlock ();
+    task ();
+    lock.lock ();
+    --running;
+    if (tasks.empty () && !running)
+      task_done.notify_all ();
+    return true;
+  }
+
+  void ThreadPool::wait (void)
+  {
+    unique_lock<mutex> lock (queue_mutex);
+    while (!tasks.empty () || running)
+    {
+      if (!runPending (lock))
+        task_done.wait (lock);
+    }
+  }
+
+  void ThreadPool::workerLoop (void)
+  {
+    TRACE_THREAD_NAME ("worker");
+    unique_lock<mutex> lock (queue_mutex);
+    while (true)
+    {
+      task_ready.wait (lock, [this] { return stop || !tasks.empty (); });
+      if (stop)
+        return;
+      runPending (lock);
+    }
+  }
+
+  /* shared between the caller and the helpers of one parallelFor call,
+   * helpers may start after the call returned and find nothing to do */
+  struct t_parallel_state
+  {
+      t_range_task job;
+      size_t n;
+      size_t n_chunks;
+      size_t chunk_size;
+      atomic<size_t> next_chunk;
+      atomic<size_t> done_chunks;
+      mutex done_mutex;
+      condition_variable done_cv;
+  };
+
+  static void run_chunks (t_parallel_state & state)
+  {
+    size_t chunk;
+    while ((chunk = state.next_chunk++) < state.n_chunks)
+    {
+      size_t begin = chunk * state.chunk_size;
+      size_t end = min (state.n, begin + state.chunk_size);
+      state.job (begin, end, chunk);
+      if (++state.done_chunks == state.n_chunks)
+      {
+        unique_lock<mutex> lock (state.done_mutex);
+        state.done_cv.notify_all ();
+      }
+    }
+  }
+
+  void ThreadPool::parallelFor (size_t n, size_t n_chunks,
+                                const t_range_task & job)
+  {
+    if (!n)
+      return;
+    if (n_chunks > n)
+      n_chunks = n;
+    if (workers.empty () || n_chunks <= 1)
+    {
+      job (0, n, 0);
+      return;
+    }
+
+    shared_ptr<t_parallel_state> state (new t_parallel_state);
+    state->job = job;
+    state->n = n;
+    state->chunk_size = (n + n_chunks - 1) / n_chunks;
+    state->n_chunks = (n + state->chunk_size - 1) / state->chunk_size;
+    state->next_chunk = 0;
+    state->done_chunks = 0;
+
+    /* chunks are claimed, not assigned: if the workers are busy with
+     * other tasks the calling thread just does all of them */
+    size_t helpers = min (workers.size (), state->n_chunks - 1);
+    for (size_t i = 0; i < helpers; ++i)
+      submit ([state] () { run_chunks (*state); });
+
+    run_chunks (*state);
+
+    unique_lock<mutex> lock (state->done_mutex);
+    state->done_cv.wait (lock, [&state]
+      { return state->done_chunks == state->n_chunks; });
+  }
+
+} /* namespace jumpinjack */
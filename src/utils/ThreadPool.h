@@ -0,0 +1,58 @@
+/*
+ * ThreadPool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_THREADPOOL_H_
+#define UTILS_THREADPOOL_H_
+
+#include <cstddef>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+namespace jumpinjack
+{
+
+  typedef std::function<void (void)> t_task;
+  typedef std::function<void (size_t begin, size_t end, int chunk)> t_range_task;
+
+  class ThreadPool
+  {
+    public:
+      /* 0 threads means one per available core (the caller counts as one) */
+      ThreadPool (int n_threads = 0);
+      virtual ~ThreadPool ();
+
+      int getThreadCount (void) const;
+
+      void submit (t_task task);
+      void wait (void);
+
+      /* split [0,n) in up to n_chunks consecutive ranges and run them in
+       * parallel, returns when all of them are done */
+      void parallelFor (size_t n, size_t n_chunks, const t_range_task & job);
+
+    private:
+      void workerLoop (void);
+      bool runPending (std::unique_lock<std::mutex> & lock);
+
+      std::vector<std::thread> workers;
+      std::deque<t_task> tasks;
+      std::mutex queue_mutex;
+      std::condition_variable task_ready;
+      std::condition_variable task_done;
+      int running;
+      bool stop;
+  };
+
+} /* namespace jumpinjack */
+
+#endif /* UTILS_THREADPOOL_H_ */
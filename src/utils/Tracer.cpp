@@ -0,0 +1,143 @@
+/*
+ * Tracer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#include "Tracer.h"
+
+#ifdef JJ_TRACE
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace jumpinjack
+{
+
+  typedef struct
+  {
+      const char * name;
+      std::string dynamic_name;  /* when name is null */
+      uint64_t start;
+      uint64_t duration;
+  } t_trace_event;
+
+  typedef struct
+  {
+      /* only contended while exporting */
+      std::mutex mutex;
+      std::vector<t_trace_event> events;
+      std::string thread_name;
+      int tid;
+  } t_trace_buffer;
+
+  static mutex registry_mutex;
+  static vector<shared_ptr<t_trace_buffer> > registry;
+
+  /* buffers outlive their threads, the registry keeps them */
+  static t_trace_buffer & local_buffer (void)
+  {
+    static thread_local shared_ptr<t_trace_buffer> buffer;
+    if (!buffer)
+    {
+      buffer = make_shared<t_trace_buffer> ();
+      buffer->events.reserve (4096);
+      unique_lock<mutex> lock (registry_mutex);
+      buffer->tid = registry.size () + 1;
+      registry.push_back (buffer);
+    }
+    return *buffer;
+  }
+
+  uint64_t Tracer::now (void)
+  {
+    return chrono::duration_cast<chrono::nanoseconds> (
+        chrono::steady_clock::now ().time_since_epoch ()).count ();
+  }
+
+  void Tracer::record (const char * name, uint64_t start, uint64_t end)
+  {
+    t_trace_buffer & buffer = local_buffer ();
+    unique_lock<mutex> lock (buffer.mutex);
+    if (buffer.events.size () < TRACE_MAX_EVENTS)
+      buffer.events.push_back (
+        { name, string (), start, end - start });
+  }
+
+  void Tracer::record (const string & name, uint64_t start, uint64_t end)
+  {
+    t_trace_buffer & buffer = local_buffer ();
+    unique_lock<mutex> lock (buffer.mutex);
+    if (buffer.events.size () < TRACE_MAX_EVENTS)
+      buffer.events.push_back (
+        { 0, name, start, end - start });
+  }
+
+  void Tracer::setThreadName (const char * name)
+  {
+    t_trace_buffer & buffer = local_buffer ();
+    unique_lock<mutex> lock (buffer.mutex);
+    buffer.thread_name = name;
+  }
+
+  static void write_string (ostream & out, const string & text)
+  {
+    out << '"';
+    for (char c : text)
+    {
+      if (c == '"' || c == '\\')
+        out << '\\' << c;
+      else if ((unsigned char) c >= 0x20)
+        out << c;
+    }
+    out << '"';
+  }
+
+  bool Tracer::exportJson (const string & path)
+  {
+    ofstream out (path.c_str (), ios::trunc);
+    if (!out.is_open ())
+      return false;
+
+    /* microseconds with ns precision */
+    out.setf (ios::fixed);
+    out.precision (3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    unique_lock<mutex> registry_lock (registry_mutex);
+    for (shared_ptr<t_trace_buffer> & buffer : registry)
+    {
+      unique_lock<mutex> lock (buffer->mutex);
+      if (!buffer->thread_name.empty ())
+      {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\","
+            << "\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":";
+        write_string (out, buffer->thread_name);
+        out << "}}";
+        first = false;
+      }
+      for (const t_trace_event & event : buffer->events)
+      {
+        out << (first ? "" : ",") << "\n{\"name\":";
+        write_string (out, event.name ? event.name : event.dynamic_name);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":"
+            << event.duration / 1000.0 << "}";
+        first = false;
+      }
+    }
+    out << "\n]}\n";
+    return out.good ();
+  }
+
+} /* namespace jumpinjack */
+
+#endif /* JJ_TRACE */
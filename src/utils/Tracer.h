@@ -0,0 +1,104 @@
+/*
+ * Tracer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: diego
+ */
+
+#ifndef UTILS_TRACER_H_
+#define UTILS_TRACER_H_
+
+/* scoped zones for chrome://tracing or Perfetto, built with JJ_TRACE
+ * (make TRACE=1). Without it the macros expand to nothing, arguments
+ * included.
+ *
+ *   TRACE_ZONE ("name");           static string, the usual case
+ *   TRACE_ZONE_DYNAMIC (path);     copied, for per asset zones
+ *   TRACE_THREAD_NAME ("worker");
+ *   TRACE_EXPORT (file);           writes the JSON, false on error
+ *
+ * TRACE_ZONE also names the zone for the allocation tracker.
+ */
+
+#include "AllocTracker.h"
+
+#ifdef JJ_TRACE
+
+#include <cstdint>
+#include <string>
+
+/* per thread, later zones are dropped */
+#define TRACE_MAX_EVENTS (1 << 20)
+
+namespace jumpinjack
+{
+
+  class Tracer
+  {
+    public:
+      /* ns on the steady clock */
+      static uint64_t now (void);
+      static void record (const char * name, uint64_t start, uint64_t end);
+      static void record (const std::string & name, uint64_t start,
+                          uint64_t end);
+      static void setThreadName (const char * name);
+      /* threads that are still tracing are locked out while it runs */
+      static bool exportJson (const std::string & path);
+  };
+
+  class TraceZone
+  {
+    public:
+      TraceZone (const char * name) :
+          name (name), start (Tracer::now ())
+      {
+      }
+      ~TraceZone ()
+      {
+        Tracer::record (name, start, Tracer::now ());
+      }
+
+    private:
+      const char * name;
+      uint64_t start;
+  };
+
+  class TraceZoneDynamic
+  {
+    public:
+      TraceZoneDynamic (const std::string & name) :
+          name (name), start (Tracer::now ())
+      {
+      }
+      ~TraceZoneDynamic ()
+      {
+        Tracer::record (name, start, Tracer::now ());
+      }
+
+    private:
+      std::string name;
+      uint64_t start;
+  };
+
+} /* namespace jumpinjack */
+
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+#define TRACE_ZONE(name) \
+  ::jumpinjack::TraceZone TRACE_JOIN(trace_zone_, __LINE__) (name); \
+  ALLOC_ZONE (name)
+#define TRACE_ZONE_DYNAMIC(name) \
+  ::jumpinjack::TraceZoneDynamic TRACE_JOIN(trace_zone_, __LINE__) (name)
+#define TRACE_THREAD_NAME(name) ::jumpinjack::Tracer::setThreadName (name)
+#define TRACE_EXPORT(path) ::jumpinjack::Tracer::exportJson (path)
+
+#else
+
+#define TRACE_ZONE(name) ALLOC_ZONE (name)
+#define TRACE_ZONE_DYNAMIC(name)
+#define TRACE_THREAD_NAME(name)
+#define TRACE_EXPORT(path) (false)
+
+#endif /* JJ_TRACE */
+
+#endif /* UTILS_TRACER_H_ */
@@ -0,0 +1,86 @@
+//============================================================================
+// Name        : jjpack.cpp
+// Description : Packs the data directory into the single file served by
+//               AssetPack
+//============================================================================
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "../src/sdl/AssetPack.h"
+
+using namespace jumpinjack;
+using namespace std;
+
+static bool has_suffix (const string & name, const char * suffix)
+{
+  size_t length = strlen (suffix);
+  return name.size () >= length
+      && name.compare (name.size () - length, length, suffix) == 0;
+}
+
+/* editor sources (img/master) and previous packs are not shipped */
+static bool skip_entry (const string & name)
+{
+  return name[0] == '.' || name == "master" || has_suffix (name, ".xcf")
+      || has_suffix (name, ".pak");
+}
+
+static bool collect (const string & root, const string & relative,
+                     vector<string> & files)
+{
+  string path = relative.empty () ? root : root + "/" + relative;
+  DIR * dir = opendir (path.c_str ());
+  if (!dir)
+  {
+    fprintf (stderr, "Unable to open %s\n", path.c_str ());
+    return false;
+  }
+
+  bool ok = true;
+  while (struct dirent * entry = readdir (dir))
+  {
+    string name = entry->d_name;
+    if (skip_entry (name))
+      continue;
+
+    string child = relative.empty () ? name : relative + "/" + name;
+    struct stat st;
+    if (stat ((root + "/" + child).c_str (), &st) < 0)
+      continue;
+    if (S_ISDIR(st.st_mode))
+      ok = collect (root, child, files) && ok;
+    else if (S_ISREG(st.st_mode))
+      files.push_back (child);
+  }
+  closedir (dir);
+  return ok;
+}
+
+int main (int argc, char ** argv)
+{
+  if (argc != 3)
+  {
+    fprintf (stderr, "usage: jjpack data_dir output.pak\n");
+    return 1;
+  }
+
+  vector<string> files;
+  if (!collect (argv[1], "", files))
+    return 1;
+
+  if (!AssetPack::write (argv[2], argv[1], files))
+  {
+    fprintf (stderr, "Unable to write %s\n", argv[2]);
+    return 1;
+  }
+
+  printf ("%s: %lu files\n", argv[2], (unsigned long) files.size ());
+  return 0;
+}
@@ -0,0 +1,132 @@
+//============================================================================
+// Name        : jjstat.cpp
+// Description : Prints the live counters a running jumpinjack publishes
+//               in shared memory
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "../src/utils/Counters.h"
+
+using namespace jumpinjack;
+using namespace std;
+
+typedef struct
+{
+    uint64_t frame;
+    uint64_t timestamp_ns;
+    uint64_t totals[COUNTER_COUNT];
+    uint64_t last_frame[COUNTER_COUNT];
+} t_snapshot;
+
+static void usage (void)
+{
+  fprintf (stderr, "usage: jjstat [-i interval_ms] [segment]\n"
+           "  segment defaults to " STATS_SEGMENT_NAME "\n");
+}
+
+/* seqlock read: retry while the writer is in the middle of a frame */
+static void take_snapshot (const t_stats_segment * segment,
+                           t_snapshot & snapshot)
+{
+  uint32_t before, after;
+  do
+  {
+    while ((before = segment->sequence.load (memory_order_acquire)) & 1)
+      ;
+    snapshot.frame = segment->frame.load (memory_order_relaxed);
+    snapshot.timestamp_ns = segment->timestamp_ns.load (memory_order_relaxed);
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+      snapshot.totals[c] = segment->totals[c].load (memory_order_relaxed);
+      snapshot.last_frame[c] =
+          segment->last_frame[c].load (memory_order_relaxed);
+    }
+    atomic_thread_fence (memory_order_acquire);
+    after = segment->sequence.load (memory_order_relaxed);
+  } while (before != after);
+}
+
+int main (int argc, char ** argv)
+{
+  const char * name = STATS_SEGMENT_NAME;
+  int interval_ms = 1000;
+  int opt;
+  while ((opt = getopt (argc, argv, "i:h")) != -1)
+  {
+    if (opt == 'i' && atoi (optarg) > 0)
+      interval_ms = atoi (optarg);
+    else
+    {
+      usage ();
+      return 1;
+    }
+  }
+  if (optind < argc)
+    name = argv[optind];
+
+  int fd = shm_open (name, O_RDONLY, 0);
+  if (fd < 0)
+  {
+    fprintf (stderr, "No counters at %s, is the game running?\n", name);
+    return 1;
+  }
+  void * mapping = mmap (0, sizeof(t_stats_segment), PROT_READ, MAP_SHARED,
+                         fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    return 1;
+
+  const t_stats_segment * segment = (const t_stats_segment *) mapping;
+  if (segment->magic != STATS_SEGMENT_MAGIC
+      || segment->version != STATS_SEGMENT_VERSION
+      || segment->counter_count != COUNTER_COUNT)
+  {
+    fprintf (stderr, "%s has an unknown layout\n", name);
+    return 1;
+  }
+  atomic_thread_fence (memory_order_acquire);
+
+  t_snapshot previous, current;
+  take_snapshot (segment, previous);
+  while (kill (segment->pid, 0) == 0)
+  {
+    usleep (interval_ms * 1000);
+    take_snapshot (segment, current);
+
+    uint64_t frames = current.frame - previous.frame;
+    double seconds = (current.timestamp_ns - previous.timestamp_ns) / 1e9;
+    printf ("\npid %u  frame %llu  %.1f fps\n", segment->pid,
+            (unsigned long long) current.frame,
+            seconds > 0 ? frames / seconds : 0.0);
+    printf ("%-18s %12s %12s %12s\n", "counter", "per sec", "per frame",
+            "last frame");
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+      if (segment->kinds[c] == COUNTER_KIND_GAUGE)
+      {
+        printf ("%-18s %12s %12s %12llu\n", segment->names[c], "", "",
+                (unsigned long long) current.last_frame[c]);
+        continue;
+      }
+      uint64_t delta = current.totals[c] - previous.totals[c];
+      printf ("%-18s %12.1f %12.2f %12llu\n", segment->names[c],
+              seconds > 0 ? delta / seconds : 0.0,
+              frames ? (double) delta / frames : 0.0,
+              (unsigned long long) current.last_frame[c]);
+    }
+    fflush (stdout);
+    previous = current;
+  }
+
+  printf ("pid %u is gone\n", segment->pid);
+  munmap (mapping, sizeof(t_stats_segment));
+  return 0;
+}
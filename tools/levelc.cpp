@@ -0,0 +1,116 @@
+//============================================================================
+// Name        : levelc.cpp
+// Description : Compiles levelN.dat text levels into the binary format
+//               loaded by LevelFile
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <vector>
+
+#include "../src/GlobalDefs.h"
+#include "../src/level/LevelFile.h"
+#include "../src/level/Surface.h"
+
+using namespace jumpinjack;
+using namespace std;
+
+static void usage (void)
+{
+  fprintf (stderr, "usage: levelc [-g] input.dat output.jjl\n"
+           "  -g  embed the collision grid computed from the foreground\n");
+}
+
+static bool build_grid (const string & image_file, vector<Uint8> & grid,
+                        int * width, int * height)
+{
+  SDL_Surface * loaded = IMG_Load (image_file.c_str ());
+  if (loaded == NULL)
+  {
+    fprintf (stderr, "Unable to load image %s! SDL_image Error: %s\n",
+             image_file.c_str (), IMG_GetError ());
+    return false;
+  }
+
+  /* same byte order Surface::getPixel expects from an RGBA png */
+  SDL_Surface * surface = SDL_ConvertSurfaceFormat (loaded,
+                                                    SDL_PIXELFORMAT_ABGR8888,
+                                                    0);
+  SDL_FreeSurface (loaded);
+  if (surface == NULL)
+  {
+    fprintf (stderr, "Unable to convert %s: %s\n", image_file.c_str (),
+             SDL_GetError ());
+    return false;
+  }
+
+  *width = surface->w;
+  *height = surface->h;
+  grid.resize ((size_t) surface->w * surface->h);
+  for (int y = 0; y < surface->h; ++y)
+  {
+    const int * row = (const int *) ((const Uint8 *) surface->pixels
+        + y * surface->pitch);
+    for (int x = 0; x < surface->w; ++x)
+      grid[(size_t) y * surface->w + x] = Surface::classifyPixel (
+          row[x] & 0xFFFFFF);
+  }
+  SDL_FreeSurface (surface);
+  return true;
+}
+
+int main (int argc, char ** argv)
+{
+  bool embed_grid = false;
+  int arg = 1;
+  if (arg < argc && !strcmp (argv[arg], "-g"))
+  {
+    embed_grid = true;
+    ++arg;
+  }
+  if (argc - arg != 2)
+  {
+    usage ();
+    return EXIT_FAILURE;
+  }
+
+  ifstream input (argv[arg]);
+  if (!input.is_open ())
+  {
+    fprintf (stderr, "Unable to open %s\n", argv[arg]);
+    return EXIT_FAILURE;
+  }
+
+  /* all MAX_PLAYERS start points are kept */
+  t_level_data level_data;
+  if (!parseLevelText (input, MAX_PLAYERS, level_data))
+  {
+    fprintf (stderr, "%s: truncated level file\n", argv[arg]);
+    return EXIT_FAILURE;
+  }
+
+  vector<Uint8> grid;
+  int grid_width = 0, grid_height = 0;
+  if (embed_grid
+      && !build_grid (GlobalDefs::getResource (
+                          RESOURCE_IMAGE, level_data.surface_filename.c_str ()),
+                      grid, &grid_width, &grid_height))
+    return EXIT_FAILURE;
+
+  if (!LevelFile::write (argv[arg + 1], level_data,
+                         embed_grid ? grid.data () : 0, grid_width,
+                         grid_height))
+  {
+    fprintf (stderr, "Unable to write %s\n", argv[arg + 1]);
+    return EXIT_FAILURE;
+  }
+
+  printf ("%s: %d items, %d layers%s\n", argv[arg + 1],
+          (int) level_data.items.size (),
+          (int) level_data.parallax_layers.size (),
+          embed_grid ? ", collision grid" : "");
+  return EXIT_SUCCESS;
+}